@@ -0,0 +1,107 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * A fixed-size set of bits, stored in 64-bit words, so that sets
+ * can be combined and counted a word at a time.
+ * Bits beyond the size are always kept clear.
+ *
+ * Include synopsis:
+ * #include <bitset>
+ * #include <cstddef>
+ * #include <vector>
+ *
+ */
+
+#ifndef BITMAP_
+#define BITMAP_
+
+#include <bitset>
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+class Bitmap {
+private:
+	typedef unsigned long long word_type;
+	static const size_t word_bits = 64;
+	vector <word_type> words;
+	size_t nbits;			// Number of bits
+
+	// Clear the unused bits of the last word
+	void trim() {
+		if (nbits % word_bits)
+			words.back() &= ((word_type)1 << (nbits % word_bits)) - 1;
+	}
+public:
+	// A bitmap of n bits, all set to v
+	Bitmap(size_t n = 0, bool v = false) :
+		words((n + word_bits - 1) / word_bits, v ? ~(word_type)0 : 0),
+		nbits(n) { trim(); }
+	size_t size() const { return nbits; }
+	void set(size_t i) { words[i / word_bits] |= (word_type)1 << (i % word_bits); }
+	bool test(size_t i) const { return (words[i / word_bits] >> (i % word_bits)) & 1; }
+
+	// Bitwise operations with a bitmap of the same size
+	Bitmap &operator&=(const Bitmap &b) {
+		for (size_t i = 0; i < words.size(); i++)
+			words[i] &= b.words[i];
+		return *this;
+	}
+	Bitmap &operator|=(const Bitmap &b) {
+		for (size_t i = 0; i < words.size(); i++)
+			words[i] |= b.words[i];
+		return *this;
+	}
+	// Clear the bits set in b
+	Bitmap &and_not(const Bitmap &b) {
+		for (size_t i = 0; i < words.size(); i++)
+			words[i] &= ~b.words[i];
+		return *this;
+	}
+	// Invert all bits
+	Bitmap &flip() {
+		for (size_t i = 0; i < words.size(); i++)
+			words[i] = ~words[i];
+		trim();
+		return *this;
+	}
+
+	// Return the number of bits set
+	size_t count() const {
+		size_t n = 0;
+		for (size_t i = 0; i < words.size(); i++)
+			n += bitset <word_bits>(words[i]).count();
+		return n;
+	}
+	// Return the position of the first bit set at or after i, or size()
+	size_t next(size_t i) const {
+		for (size_t w = i / word_bits; w < words.size(); w++, i = w * word_bits) {
+			word_type bits = words[w] >> (i % word_bits);
+			if (bits == 0)
+				continue;
+			for (; !(bits & 1); bits >>= 1)
+				i++;
+			return i;
+		}
+		return nbits;
+	}
+};
+
+#endif /* BITMAP_ */
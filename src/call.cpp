@@ -125,6 +125,7 @@ Call::register_call(Call *from, Call *to)
 Call::Call(const string &s, const Token &t) :
 		name(s),
 		m(this),
+		processed_unit(0),
 		curr_stmt_nesting(0),
 		token(t)
 {
@@ -137,7 +138,7 @@ Call::Call(const string &s, const Token &t) :
 bool
 Call::contains(Eclass *e) const
 {
-	for (dequeTpart::const_iterator i = get_token().get_parts_begin(); i != get_token().get_parts_end(); i++) {
+	for (vectorTpart::const_iterator i = get_token().get_parts_begin(); i != get_token().get_parts_end(); i++) {
 		int len = i->get_len();
 		Tokid t = i->get_tokid();
 		for (int pos = 0; pos < len;) {
@@ -159,15 +160,13 @@ Call::contains(Eclass *e) const
 void
 Call::clear_visit_flags()
 {
-	for (const_fmap_iterator_type i = all.begin(); i != all.end(); i++)
-		i->second->visited = false;
+	VisitMark <call_visit_tag>::clear_all();
 }
 
 void
 Call::clear_print_flags()
 {
-	for (const_fmap_iterator_type i = all.begin(); i != all.end(); i++)
-		i->second->printed = false;
+	VisitMark <call_print_tag>::clear_all();
 }
 
 Call *
@@ -214,6 +213,7 @@ Call::mark_end()
 		end.get_tokid().get_fileid().add_function(this);
 	m.summarize_operators();
 	m.done_processing();
+	processed_unit = Pdtoken::get_unit();
 }
 
 // Return true if the span represents a file region
@@ -253,41 +253,40 @@ Call::dumpSql(Sql *db, ostream &of)
 	for (const_fmap_iterator_type i = fbegin(); i != fend(); i++) {
 		Call *fun = i->second;
 		Tokid t = fun->get_site();
-		of << "INSERT INTO FUNCTIONS VALUES(" <<
-		ptr_offset(fun) << ", '" <<
-		fun->name << "', " <<
-		db->boolval(fun->is_macro()) << ',' <<
-		db->boolval(fun->is_defined()) << ',' <<
-		db->boolval(fun->is_declared()) << ',' <<
-		db->boolval(fun->is_file_scoped()) << ',' <<
-		t.get_fileid().get_id() << ',' <<
-		(unsigned)(t.get_streampos()) << ',' <<
+		SqlRow(db, of, "FUNCTIONS") <<
+		ptr_offset(fun) <<
+		fun->name <<
+		fun->is_macro() <<
+		fun->is_defined() <<
+		fun->is_declared() <<
+		fun->is_file_scoped() <<
+		t.get_fileid().get_id() <<
+		(unsigned)(t.get_streampos()) <<
 		fun->get_num_caller();
-		of << ");\n";
 
 		if (fun->is_defined()) {
-			of << "INSERT INTO FUNCTIONMETRICS VALUES(" << ptr_offset(fun);
+			SqlRow row(db, of, "FUNCTIONMETRICS");
+			row << ptr_offset(fun);
 			for (int j = 0; j < FunMetrics::metric_max; j++)
 				if (!Metrics::is_internal<FunMetrics>(j))
-					cout << ',' << fun->metrics().get_metric(j);
-			of << ',' << fun->get_begin().get_tokid().get_fileid().get_id() <<
-			',' << (unsigned)(fun->get_begin().get_tokid().get_streampos()) <<
-			',' << fun->get_end().get_tokid().get_fileid().get_id() <<
-			',' << (unsigned)(fun->get_end().get_tokid().get_streampos());
-			of << ");\n";
+					row << fun->metrics().get_metric(j);
+			row << fun->get_begin().get_tokid().get_fileid().get_id() <<
+			(unsigned)(fun->get_begin().get_tokid().get_streampos()) <<
+			fun->get_end().get_tokid().get_fileid().get_id() <<
+			(unsigned)(fun->get_end().get_tokid().get_streampos());
 		}
 
 		int start = 0, ord = 0;
-		for (dequeTpart::const_iterator j = fun->get_token().get_parts_begin(); j != fun->get_token().get_parts_end(); j++) {
+		for (vectorTpart::const_iterator j = fun->get_token().get_parts_begin(); j != fun->get_token().get_parts_end(); j++) {
 			Tokid t2 = j->get_tokid();
 			int len = j->get_len() - start;
 			int pos = 0;
 			while (pos < len) {
 				Eclass *ec = t2.get_ec();
-				of << "INSERT INTO FUNCTIONID VALUES(" <<
-				ptr_offset(fun) << ',' <<
-				ord << ',' <<
-				ptr_offset(ec) << ");\n";
+				SqlRow(db, of, "FUNCTIONID") <<
+				ptr_offset(fun) <<
+				ord <<
+				ptr_offset(ec);
 				pos += ec->get_len();
 				t2 += ec->get_len();
 				ord++;
@@ -300,8 +299,8 @@ Call::dumpSql(Sql *db, ostream &of)
 	for (const_fmap_iterator_type i = fbegin(); i != fend(); i++) {
 		Call *fun = i->second;
 		for (Call::const_fiterator_type dest = fun->call_begin(); dest != fun->call_end(); dest++)
-			of << "INSERT INTO FCALLS VALUES(" <<
-			    ptr_offset(fun) << ',' <<
-			    ptr_offset(*dest) << ");\n";
+			SqlRow(db, of, "FCALLS") <<
+			    ptr_offset(fun) <<
+			    ptr_offset(*dest);
 	}
 }
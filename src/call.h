@@ -28,11 +28,16 @@
 #include "tokid.h"
 #include "fchar.h"
 #include "token.h"
+#include "pool.h"
+#include "visitmark.h"
 
 class FCall;
 class Sql;
 class Id;
 class Ctoken;
+// Kinds of graph traversal marks
+struct call_visit_tag;
+struct call_print_tag;
 
 /*
  * Generic call information of a called/calling entity.
@@ -56,6 +61,7 @@ class Ctoken;
  *	macro names consisting of multiple parts
  */
 class Call {
+	friend class Snapshot;
 private:
 
 	// Container for storing all declared functions
@@ -77,10 +83,11 @@ private:
 	string name;			// Function's name
 	fun_container call;		// Functions this function calls
 	fun_container caller;		// Functions that call this function
-	unsigned char visited;		// For calculating transitive closures (bit mask or boolean)
-	bool printed;			// For printing a graph's nodes
+	VisitMark <call_visit_tag> visited;	// For calculating transitive closures (bit mask or boolean)
+	VisitMark <call_print_tag> printed;	// For printing a graph's nodes
 	FcharContext begin, end;	// Span of definition
 	FunMetrics m;			// Metrics for this function
+	int processed_unit;		// Unit that processed the body (see Pdtoken::get_unit)
 	int curr_stmt_nesting;		// Current level of nesting
 	static int macro_nesting;	// Level of nesting through macro tokens
 
@@ -103,6 +110,8 @@ protected:
 	Token token;
 
 public:
+	static void *operator new(size_t s) { return Pool::allocate(s); }
+	static void operator delete(void *p, size_t s) { Pool::deallocate(p, s); }
 	// Called when outside a function / macro body scope
 	static void unset_current_fun();
 	// The current function makes a call to id
@@ -149,14 +158,14 @@ public:
 	int get_num_call() const { return call.size(); }
 	int get_num_caller() const { return caller.size(); }
 
-	void set_visited() { visited = true; }
+	void set_visited() { visited.set(); }
 	// Bit-or the specified visit flag
-	void set_visited(unsigned char v) { visited |= v; }
-	bool is_visited() const { return (bool)visited; }
-	bool is_visited(unsigned short visit_id) const { return (bool)(visited & visit_id); }
-	unsigned char get_visited() const { return visited; }
-	void set_printed() { printed = true; }
-	bool is_printed() const { return printed; }
+	void set_visited(unsigned char v) { visited.set(v); }
+	bool is_visited() const { return (bool)visited.get(); }
+	bool is_visited(unsigned short visit_id) const { return (bool)(visited.get() & visit_id); }
+	unsigned char get_visited() const { return visited.get(); }
+	void set_printed() { printed.set(); }
+	bool is_printed() const { return (bool)printed.get(); }
 
 	// Mark the function's span
 	void mark_begin();
@@ -210,6 +219,11 @@ public:
 			current_fun->m.process_token(t);
 	}
 
+	// Return true while the metrics of the current function are collected
+	static bool collecting_metrics() {
+		return current_fun && !current_fun->m.is_processed();
+	}
+
 	// Call the specified metrics function for the current function
 	static inline void call_metrics(void (Metrics::*fun)()) {
 		if (current_fun)
@@ -122,16 +122,6 @@ CREATE VIRTUAL TABLE cscout.Tokid
 USING STRUCT VIEW Tokid
 WITH REGISTERED C TYPE Tokid;
 
-CREATE STRUCT VIEW TokidEquivalenceClasses (
-      FOREIGN KEY(tokid) FROM first REFERENCES Tokid,
-      FOREIGN KEY(eclass) FROM second REFERENCES Eclass POINTER
-);
-
-CREATE VIRTUAL TABLE cscout.TokidEquivalenceClasses
-USING STRUCT VIEW TokidEquivalenceClasses
-WITH REGISTERED C NAME tm
-WITH REGISTERED C TYPE map<Tokid, Eclass *>;
-
 CREATE STRUCT VIEW FunctionMap (
       FOREIGN KEY(tokid) FROM first REFERENCES Tokid,
       FOREIGN KEY(call) FROM second REFERENCES Call POINTER
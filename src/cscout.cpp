@@ -40,9 +40,16 @@
 #include <cstdlib>		// atoi
 #include <cstring>		// strdup
 #include <cerrno>		// errno
+#include <climits>		// INT_MAX
+#include <mutex>
+#include <atomic>
 #include <regex.h> // regex
 
 #include <getopt.h>
+#ifndef WIN32
+#include <sys/wait.h>		// wait(2)
+#include <unistd.h>		// fork(2), unlink(2)
+#endif
 
 #include "swill.h"
 
@@ -82,8 +89,15 @@
 #include "dirbrowse.h"
 #include "fileutils.h"
 #include "globobj.h"
-#include "fifstream.h"
+#include "fbuffer.h"
+#include "parallel.h"
+#include "snapshot.h"
+#include "profile.h"
+#include "fcgraph.h"
+#include "trigram.h"
+#include "lrucache.h"
 #include "ctag.h"
+#include "dispatch.h"
 #include "timer.h"
 
 #ifdef PICO_QL
@@ -140,6 +154,8 @@ static bool must_exit = false;
 static bool browse_only = false;
 // Maximum number of nodes and edges allowed to browsing-only clients
 #define MAX_BROWSING_GRAPH_ELEMENTS 1000
+// Number of evaluated queries whose results are kept for paging through them
+#define QUERY_CACHE_ENTRIES 20
 
 static CompiledRE sfile_re;			// Saved files replacement location RE
 
@@ -174,8 +190,6 @@ public:
 
 RefFunCall::store_type RefFunCall::store;
 
-// Matrix used to store graph edges
-typedef vector<vector<bool> > EdgeMatrix;
 
 // Boundaries of a function argument
 struct ArgBound {
@@ -208,22 +222,105 @@ graph_suffix()
 	return "";
 }
 
+// Display the progress of count out of total items (non-reentant)
+static void
+progress(size_t count, size_t total)
+{
+	static int opercent;
+
+	int percent = count * 100 / total;
+	if (percent != opercent) {
+		cerr << '\r' << percent << '%' << flush;
+		opercent = percent;
+	}
+}
+
 // Display loop progress (non-reentant)
 template <typename container>
 static void
 progress(typename container::const_iterator i, const container &c)
 {
-	static int count, opercent;
+	static int count;
 
 	if (i == c.begin())
 		count = 0;
-	int percent = ++count * 100 / c.size();
-	if (percent != opercent) {
-		cerr << '\r' << percent << '%' << flush;
-		opercent = percent;
+	progress(++count, c.size());
+}
+
+// The sorted results of an evaluated query
+struct QueryResult {
+	vector <const IdPropElem *> idents;
+	vector <Fileid> files;
+	vector <const Call *> funs;
+};
+
+/*
+ * Recently evaluated queries, keyed by the query's URL and the results
+ * shown.  Paging through the results of a query thus does not
+ * evaluate it again.  The entries are removed when the identifiers,
+ * functions, files, or options they depend on change.
+ */
+static LruCache <string, QueryResult> query_cache(QUERY_CACHE_ENTRIES);
+
+// Return the key for caching the results of query shown in views
+static string
+query_key(const Query &query, const string &views)
+{
+	ostringstream key;
+	key << query.base_url() << views << "&project=" << current_project;
+	return key.str();
+}
+
+// Indexes of the identifier and function names, used to narrow down queries
+static TrigramIndex id_name_index, fun_name_index;
+// The identifiers and functions at each index position
+static vector <IdProp::iterator> indexed_ids;
+static vector <Call::const_fmap_iterator_type> indexed_funs;
+// The attributes of the indexed identifiers
+static IdAttributes id_attributes;
+
+// Index the identifiers and functions, unless they are up to date
+static void
+index_names()
+{
+	if (indexed_ids.size() != ids.size()) {
+		id_name_index = TrigramIndex();
+		indexed_ids.clear();
+		for (IdProp::iterator i = ids.begin(); i != ids.end(); i++) {
+			indexed_ids.push_back(i);
+			id_name_index.add(i->second.get_id());
+		}
+		id_name_index.finish();
+		id_attributes.build(indexed_ids);
+		query_cache.clear();
+	}
+	if (indexed_funs.size() != Call::functions().size()) {
+		fun_name_index = TrigramIndex();
+		indexed_funs.clear();
+		for (Call::const_fmap_iterator_type i = Call::fbegin(); i != Call::fend(); i++) {
+			indexed_funs.push_back(i);
+			fun_name_index.add(i->second->get_name());
+		}
+		fun_name_index.finish();
+		query_cache.clear();
 	}
 }
 
+// Return the positions of the indexed elements whose names may match query
+template <typename Q>
+static Bitmap
+name_candidates(const Q &query, const TrigramIndex &index)
+{
+	string re;
+	vector <unsigned> pos;
+	if (!query.get_name_re(re) || !index.candidates(re, pos))
+		return Bitmap(index.size(), true);
+	Bitmap b(index.size());
+	for (vector <unsigned>::const_iterator i = pos.begin(); i != pos.end(); i++)
+		b.set(*i);
+	return b;
+}
+
 // Display an identifier hyperlink
 static void
 html(FILE *of, const IdPropElem &i)
@@ -263,7 +360,7 @@ static void
 html_string(FILE *of, const Call *f)
 {
 	int start = 0;
-	for (dequeTpart::const_iterator i = f->get_token().get_parts_begin(); i != f->get_token().get_parts_end(); i++) {
+	for (vectorTpart::const_iterator i = f->get_token().get_parts_begin(); i != f->get_token().get_parts_end(); i++) {
 		Tokid t = i->get_tokid();
 		putc('[', of);
 		html_string(of, f->get_name().substr(start, i->get_len()), t);
@@ -272,27 +369,53 @@ html_string(FILE *of, const Call *f)
 	}
 }
 
-// Add identifiers of the file fi into ids
-// Collect metrics for the file and its functions
+// Serializes progress output from multiple threads
+static mutex output_lock;
+
+// Results of a file's analysis that must be merged into the workspace
+class FileAnalysis {
+public:
+	bool defer;				// True if ECs are deleted after the analysis
+	vector <pair <Eclass *, string> > identifiers;	// Identifiers found in the file
+	vector <Eclass *> garbage;		// ECs to delete
+	FileAnalysis(bool d) : defer(d) {}
+	// Remove ec from the workspace, possibly after the analysis
+	void discard(Eclass *ec) {
+		if (defer)
+			garbage.push_back(ec);
+		else {
+			ec->remove_from_tokid_map();
+			delete ec;
+		}
+	}
+};
+
+// Collect the identifiers of the file fi into fa
+// Collect metrics for the file and its functions; identifier ones into msum
 // Populate the file's accociated files set
 // Return true if the file contains unused identifiers
+// When fa.defer is set this can run concurrently for different files
 static bool
-file_analyze(Fileid fi)
+file_analyze(Fileid fi, FileAnalysis &fa, IdMetricsSummary &msum)
 {
 	using namespace std::rel_ops;
 
-	fifstream in;
+	fbstream in;
 	bool has_unused = false;
 	const string &fname = fi.get_path();
 	int line_number = 0;
+	set <Eclass *> seen;			// ECs already in fa.identifiers
 
 	FCallSet &fc = fi.get_functions();	// File's functions
 	FCallSet::iterator fci = fc.begin();	// Iterator through them
 	Call *cfun = NULL;			// Current function
 	stack <Call *> fun_nesting;
 
-	cerr << "Post-processing " << fname << endl;
-	in.open(fname.c_str(), ios::binary);
+	{
+		lock_guard <mutex> guard(output_lock);
+		cerr << "Post-processing " << fname << endl;
+	}
+	in.open(fi);
 	if (in.fail()) {
 		perror(fname.c_str());
 		exit(1);
@@ -324,27 +447,25 @@ file_analyze(Fileid fi)
 		}
 
 		char c = (char)val;
-		mapTokidEclass::iterator ei;
+		Eclass *ec;
 		enum e_cfile_state cstate = fi.metrics().get_state();
 		if (cstate != s_block_comment &&
 		    cstate != s_string &&
 		    cstate != s_cpp_comment &&
 		    (isalnum(c) || c == '_') &&
-		    (ei = ti.find_ec()) != ti.end_ec()) {
-			Eclass *ec = (*ei).second;
+		    (ec = ti.check_ec()) != NULL) {
 			// Remove identifiers we are not supposed to monitor
 			if (monitor.is_valid()) {
 				IdPropElem ec_id(ec, Identifier());
 				if (!monitor.eval(ec_id)) {
-					ec->remove_from_tokid_map();
-					delete ec;
+					fa.discard(ec);
 					continue;
 				}
 			}
 			// Identifiers we can mark
 			if (ec->is_identifier()) {
 				// Update metrics
-				id_msum.add_id(ec);
+				msum.add_id(ec);
 				// Add to the map
 				string s(1, c);
 				int len = ec->get_len();
@@ -353,14 +474,9 @@ file_analyze(Fileid fi)
 				fi.metrics().process_id(s, ec);
 				if (cfun)
 					cfun->metrics().process_id(s, ec);
-				/*
-				 * ids[ec] = Identifier(ec, s);
-				 * Efficiently add s to ids, if needed.
-				 * See Meyers, effective STL, Item 24.
-				 */
-				IdProp::iterator idi = ids.lower_bound(ec);
-				if (idi == ids.end() || idi->first != ec)
-					ids.insert(idi, IdProp::value_type(ec, Identifier(ec, s)));
+				// Added to ids by files_analyze()
+				if (seen.insert(ec).second)
+					fa.identifiers.push_back(make_pair(ec, s));
 				if (ec->is_unused())
 					has_unused = true;
 				else
@@ -373,8 +489,7 @@ file_analyze(Fileid fi)
 				 * even reserved words get an EC. These are
 				 * cleared here.)
 				 */
-				ec->remove_from_tokid_map();
-				delete ec;
+				fa.discard(ec);
 			}
 		}
 		fi.metrics().process_char((char)val);
@@ -395,11 +510,59 @@ file_analyze(Fileid fi)
 	return has_unused;
 }
 
+/*
+ * Analyze the specified files, using multiple threads, and merge
+ * the results into ids, id_msum, and the directory tree.
+ * The merge follows the files' order, so the results are the same
+ * as those of a sequential analysis.
+ */
+static void
+files_analyze(const vector <Fileid> &files)
+{
+	// Monitoring deletes ECs as it finds them, so it must run sequentially
+	bool parallel = !monitor.is_valid();
+	vector <FileAnalysis> fa(files.size(), FileAnalysis(parallel));
+	vector <IdMetricsSummary> msum(Parallel::get_threads());
+
+	auto analyze = [&](size_t i, unsigned t) {
+		file_analyze(files[i], fa[i], msum[t]);
+	};
+	if (parallel)
+		Parallel::for_each(files.size(), analyze);
+	else
+		for (size_t i = 0; i < files.size(); i++)
+			analyze(i, 0);
+
+	set <Eclass *> garbage;
+	for (size_t i = 0; i < files.size(); i++) {
+		vector <pair <Eclass *, string> >::const_iterator j;
+		for (j = fa[i].identifiers.begin(); j != fa[i].identifiers.end(); j++) {
+			/*
+			 * ids[ec] = Identifier(ec, s);
+			 * Efficiently add s to ids, if needed.
+			 * See Meyers, effective STL, Item 24.
+			 */
+			IdProp::iterator idi = ids.lower_bound(j->first);
+			if (idi == ids.end() || idi->first != j->first)
+				ids.insert(idi, IdProp::value_type(j->first, Identifier(j->first, j->second)));
+		}
+		garbage.insert(fa[i].garbage.begin(), fa[i].garbage.end());
+		dir_add_file(files[i]);
+	}
+	// A discarded EC may have been found in many files
+	for (set <Eclass *>::iterator i = garbage.begin(); i != garbage.end(); i++) {
+		(*i)->remove_from_tokid_map();
+		delete *i;
+	}
+	for (vector <IdMetricsSummary>::const_iterator i = msum.begin(); i != msum.end(); i++)
+		id_msum += *i;
+}
+
 // Display the contents of a file in hypertext form
 static void
 file_hypertext(FILE *of, Fileid fi, bool eval_query)
 {
-	istream *in;
+	fbstream in;
 	const string &fname = fi.get_path();
 	bool at_bol = true;
 	int line_number = 1;
@@ -431,11 +594,11 @@ file_hypertext(FILE *of, Fileid fi, bool eval_query)
 	if (DP())
 		cout << "Write to " << fname << endl;
 	if (fi.is_hand_edited()) {
-		in = new istringstream(fi.get_original_contents());
+		in.open_string(fi.get_original_contents());
 		fputs("<p>This file has been edited by hand. The following code reflects the contents before the first CScout-invoked hand edit.</p>", of);
 	} else {
-		in = new ifstream(fname.c_str(), ios::binary);
-		if (in->fail()) {
+		in.open(fi);
+		if (in.fail()) {
 			html_perror(of, "Unable to open " + fname + " for reading");
 			return;
 		}
@@ -447,8 +610,8 @@ file_hypertext(FILE *of, Fileid fi, bool eval_query)
 		Tokid ti;
 		int val;
 
-		ti = Tokid(fi, in->tellg());
-		if ((val = in->get()) == EOF)
+		ti = Tokid(fi, in.tellg());
+		if ((val = in.get()) == EOF)
 			break;
 		if (at_bol) {
 			fprintf(of,"<a name=\"%d\"></a>", line_number);
@@ -473,9 +636,11 @@ file_hypertext(FILE *of, Fileid fi, bool eval_query)
 			s = (char)val;
 			int len = ec->get_len();
 			for (int j = 1; j < len; j++)
-				s += (char)in->get();
-			Identifier i(ec, s);
-			const IdPropElem ip(ec, i);
+				s += (char)in.get();
+			// Use the analyzed identifier, which has xfile set
+			IdProp::const_iterator idi = ids.find(ec);
+			const IdPropElem ip(idi == ids.end() ?
+			    IdPropElem(ec, Identifier(ec, s)) : *idi);
 			if (idq.eval(ip))
 				html(of, ip);
 			else
@@ -492,7 +657,7 @@ file_hypertext(FILE *of, Fileid fi, bool eval_query)
 					s = (char)val;
 					int len = ci->second->get_name().length();
 					for (int j = 1; j < len; j++)
-						s += (char)in->get();
+						s += (char)in.get();
 					html(of, *(ci->second));
 					break;
 				}
@@ -507,7 +672,7 @@ file_hypertext(FILE *of, Fileid fi, bool eval_query)
 			line_number++;
 		}
 	}
-	delete in;
+	in.close();
 	fputs("<hr></code>", of);
 }
 
@@ -771,7 +936,7 @@ function_argument_replace(string::const_iterator begin, string::const_iterator e
  * function arguments reordered.
  */
 static string
-get_refactored_part(fifstream &in, Fileid fid)
+get_refactored_part(fbstream &in, Fileid fid)
 {
 	Tokid ti;
 	int val;
@@ -833,14 +998,14 @@ static void
 file_refactor(FILE *of, Fileid fid)
 {
 	string plain;
-	fifstream in;
+	fbstream in;
 	ofstream out;
 
 	cerr << "Processing file " << fid.get_path() << endl;
 
 	if (RefFunCall::store.size())
 		establish_argument_boundaries(fid.get_path());
-	in.open(fid.get_path().c_str(), ios::binary);
+	in.open(fid);
 	if (in.fail()) {
 		html_perror(of, "Unable to open " + fid.get_path() + " for reading");
 		return;
@@ -858,6 +1023,7 @@ file_refactor(FILE *of, Fileid fid)
 
 	// Needed for Windows
 	in.close();
+	Fbuffer::invalidate(fid);
 	out.close();
 
 	if (Option::sfile_re_string->get().length()) {
@@ -1031,14 +1197,20 @@ xfilequery_page(FILE *of,  void *p)
 	if (!query.is_valid())
 		return;
 
-	multiset <Fileid, FileQuery::specified_order> sorted_files;
-
 	html_head(of, "xfilequery", (qname && *qname) ? qname : "File Query Results");
 
-	for (vector <Fileid>::iterator i = files.begin(); i != files.end(); i++) {
-		if (query.eval(*i))
-			sorted_files.insert(*i);
+	string key(query_key(query, ""));
+	QueryResult *result = query_cache.get(key);
+	if (!result) {
+		multiset <Fileid, FileQuery::specified_order> sorted_files;
+		for (vector <Fileid>::iterator i = files.begin(); i != files.end(); i++) {
+			if (query.eval(*i))
+				sorted_files.insert(*i);
+		}
+		result = &query_cache.put(key);
+		result->files.assign(sorted_files.begin(), sorted_files.end());
 	}
+	const vector <Fileid> &sorted_files(result->files);
 	html_file_begin(of);
 	if (modification_state != ms_subst && !browse_only)
 		fprintf(of, "<th></th>\n");
@@ -1046,7 +1218,7 @@ xfilequery_page(FILE *of,  void *p)
 		fprintf(of, "<th>%s</th>\n", Metrics::get_name<FileMetrics>(query.get_sort_order()).c_str());
 	Pager pager(of, Option::entries_per_page->get(), query.base_url(), query.bookmarkable());
 	html_file_set_begin(of);
-	for (multiset <Fileid, FileQuery::specified_order>::iterator i = sorted_files.begin(); i != sorted_files.end(); i++) {
+	for (vector <Fileid>::const_iterator i = sorted_files.begin(); i != sorted_files.end(); i++) {
 		Fileid f = *i;
 		if (current_project && !f.get_attribute(current_project))
 			continue;
@@ -1102,7 +1274,7 @@ display_sorted(FILE *of, const Query &query, const container &sorted_ids)
  * for properly aligning the output.
  */
 static void
-display_sorted_function_metrics(FILE *of, const FunQuery &query, const Sfuns &sorted_ids)
+display_sorted_function_metrics(FILE *of, const FunQuery &query, const vector <const Call *> &sorted_ids)
 {
 	fprintf(of, "<table class=\"metrics\"><tr>"
 	    "<th width='50%%' align='left'>Name</th>"
@@ -1110,7 +1282,7 @@ display_sorted_function_metrics(FILE *of, const FunQuery &query, const Sfuns &so
 	    Metrics::get_name<FunMetrics>(query.get_sort_order()).c_str());
 
 	Pager pager(of, Option::entries_per_page->get(), query.base_url() + "&qi=1", query.bookmarkable());
-	for (Sfuns::const_iterator i = sorted_ids.begin(); i != sorted_ids.end(); i++) {
+	for (vector <const Call *>::const_iterator i = sorted_ids.begin(); i != sorted_ids.end(); i++) {
 		if (pager.show_next()) {
 			fputs("<tr><td witdh='50%'>", of);
 			html(of, **i);
@@ -1248,7 +1420,7 @@ funquery_page(FILE *of,  void *p)
 }
 
 void
-display_files(FILE *of, const Query &query, const IFSet &sorted_files)
+display_files(FILE *of, const Query &query, const vector <Fileid> &sorted_files)
 {
 	const string query_url(query.param_url());
 
@@ -1256,7 +1428,7 @@ display_files(FILE *of, const Query &query, const IFSet &sorted_files)
 	html_file_begin(of);
 	html_file_set_begin(of);
 	Pager pager(of, Option::entries_per_page->get(), query.base_url() + "&qf=1", query.bookmarkable());
-	for (IFSet::iterator i = sorted_files.begin(); i != sorted_files.end(); i++) {
+	for (vector <Fileid>::const_iterator i = sorted_files.begin(); i != sorted_files.end(); i++) {
 		Fileid f = *i;
 		if (current_project && !f.get_attribute(current_project))
 			continue;
@@ -1282,9 +1454,6 @@ xiquery_page(FILE *of,  void *p)
 	Timer timer;
 	prohibit_remote_access(of);
 
-	Sids sorted_ids;
-	IFSet sorted_files;
-	set <Call *> funs;
 	bool q_id = !!swill_getvar("qi");	// Show matching identifiers
 	bool q_file = !!swill_getvar("qf");	// Show matching files
 	bool q_fun = !!swill_getvar("qfun");	// Show matching functions
@@ -1297,33 +1466,54 @@ xiquery_page(FILE *of,  void *p)
 	}
 
 	html_head(of, "xiquery", (qname && *qname) ? qname : "Identifier Query Results");
-	cerr << "Evaluating identifier query" << endl;
-	for (IdProp::iterator i = ids.begin(); i != ids.end(); i++) {
-		progress(i, ids);
-		if (!query.eval(*i))
-			continue;
-		if (q_id)
-			sorted_ids.insert(&*i);
-		else if (q_file) {
-			IFSet f = i->first->sorted_files();
-			sorted_files.insert(f.begin(), f.end());
-		} else if (q_fun) {
-			set <Call *> ecfuns(i->first->functions());
-			funs.insert(ecfuns.begin(), ecfuns.end());
+	index_names();
+	string key(query_key(query, string(q_id ? "&qi=1" : "") + (q_file ? "&qf=1" : "") + (q_fun ? "&qfun=1" : "")));
+	QueryResult *result = query_cache.get(key);
+	if (!result) {
+		Sids sorted_ids;
+		IFSet sorted_files;
+		set <Call *> funs;
+
+		cerr << "Evaluating identifier query" << endl;
+		Bitmap candidates(name_candidates(query, id_name_index));
+		// Evaluate the attribute criteria on all identifiers at once
+		Bitmap selected;
+		bool attributes_evaluated = query.eval_attributes(id_attributes, selected);
+		if (attributes_evaluated)
+			candidates &= selected;
+		size_t ncandidates = candidates.count(), count = 0;
+		for (size_t pos = candidates.next(0); pos < candidates.size(); pos = candidates.next(pos + 1)) {
+			progress(++count, ncandidates);
+			IdProp::iterator i = indexed_ids[pos];
+			if (!(attributes_evaluated ? query.eval_re(*i) : query.eval(*i)))
+				continue;
+			if (q_id)
+				sorted_ids.insert(&*i);
+			else if (q_file) {
+				IFSet f = i->first->sorted_files();
+				sorted_files.insert(f.begin(), f.end());
+			} else if (q_fun) {
+				set <Call *> ecfuns(i->first->functions());
+				funs.insert(ecfuns.begin(), ecfuns.end());
+			}
 		}
+		cerr << endl;
+		Sfuns sorted_funs;
+		sorted_funs.insert(funs.begin(), funs.end());
+		result = &query_cache.put(key);
+		result->idents.assign(sorted_ids.begin(), sorted_ids.end());
+		result->files.assign(sorted_files.begin(), sorted_files.end());
+		result->funs.assign(sorted_funs.begin(), sorted_funs.end());
 	}
-	cerr << endl;
 	if (q_id) {
 		fputs("<h2>Matching Identifiers</h2>\n", of);
-		display_sorted(of, query, sorted_ids);
+		display_sorted(of, query, result->idents);
 	}
 	if (q_file)
-		display_files(of, query, sorted_files);
+		display_files(of, query, result->files);
 	if (q_fun) {
 		fputs("<h2>Matching Functions</h2>\n", of);
-		Sfuns sorted_funs;
-		sorted_funs.insert(funs.begin(), funs.end());
-		display_sorted(of, query, sorted_funs);
+		display_sorted(of, query, result->funs);
 	}
 
 	timer.print_elapsed(of);
@@ -1337,8 +1527,6 @@ xfunquery_page(FILE *of,  void *p)
 	prohibit_remote_access(of);
 	Timer timer;
 
-	Sfuns sorted_funs;
-	IFSet sorted_files;
 	bool q_id = !!swill_getvar("qi");	// Show matching identifiers
 	bool q_file = !!swill_getvar("qf");	// Show matching files
 	char *qname = swill_getvar("n");
@@ -1348,26 +1536,40 @@ xfunquery_page(FILE *of,  void *p)
 		return;
 
 	html_head(of, "xfunquery", (qname && *qname) ? qname : "Function Query Results");
-	cerr << "Evaluating function query" << endl;
-	for (Call::const_fmap_iterator_type i = Call::fbegin(); i != Call::fend(); i++) {
-		progress(i, Call::functions());
-		if (!query.eval(i->second))
-			continue;
-		if (q_id)
-			sorted_funs.insert(i->second);
-		if (q_file)
-			sorted_files.insert(i->second->get_fileid());
+	index_names();
+	string key(query_key(query, string(q_id ? "&qi=1" : "") + (q_file ? "&qf=1" : "")));
+	QueryResult *result = query_cache.get(key);
+	if (!result) {
+		Sfuns sorted_funs;
+		IFSet sorted_files;
+
+		cerr << "Evaluating function query" << endl;
+		Bitmap candidates(name_candidates(query, fun_name_index));
+		size_t ncandidates = candidates.count(), count = 0;
+		for (size_t pos = candidates.next(0); pos < candidates.size(); pos = candidates.next(pos + 1)) {
+			progress(++count, ncandidates);
+			Call::const_fmap_iterator_type i = indexed_funs[pos];
+			if (!query.eval(i->second))
+				continue;
+			if (q_id)
+				sorted_funs.insert(i->second);
+			if (q_file)
+				sorted_files.insert(i->second->get_fileid());
+		}
+		cerr << endl;
+		result = &query_cache.put(key);
+		result->funs.assign(sorted_funs.begin(), sorted_funs.end());
+		result->files.assign(sorted_files.begin(), sorted_files.end());
 	}
-	cerr << endl;
 	if (q_id) {
 		fputs("<h2>Matching Functions</h2>\n", of);
 		if (query.get_sort_order() != -1)
-			display_sorted_function_metrics(of, query, sorted_funs);
+			display_sorted_function_metrics(of, query, result->funs);
 		else
-			display_sorted(of, query, sorted_funs);
+			display_sorted(of, query, result->funs);
 	}
 	if (q_file)
-		display_files(of, query, sorted_files);
+		display_files(of, query, result->files);
 	timer.print_elapsed(of);
 	html_tail(of);
 }
@@ -1404,6 +1606,7 @@ identifier_page(FILE *fo, void *p)
 		string ssubst(subst);
 		id.set_newid(ssubst);
 		modification_state = ms_subst;
+		query_cache.clear();
 	}
 	html_head(fo, "id", string("Identifier: ") + html(id.get_id()));
 	fprintf(fo, "<FORM ACTION=\"id.html\" METHOD=\"GET\">\n<ul>\n");
@@ -1489,6 +1692,7 @@ function_page(FILE *fo, void *p)
 		prohibit_remote_access(fo);
 		RefFunCall::store.insert(RefFunCall::store_type::value_type(ec, RefFunCall(f, subst)));
 		modification_state = ms_subst;
+		query_cache.clear();
 	}
 	html_head(fo, "fun", string("Function: ") + html(f->get_name()) + " (" + f->entity_type_name() + ')');
 	fprintf(fo, "<FORM ACTION=\"fun.html\" METHOD=\"GET\">\n");
@@ -1668,13 +1872,12 @@ visit_globobj_files(Fileid f, const Fileidset & (Fileid::*get_set)() const, int
 /*
  * Visit all files associated with a function call relationship with f
  * (a control dependency).
- * The methods to obtain the relationship iterators are passed through
- * the abegin and aend method pointers.
- * Set the visited flag for all nodes visited and the edges matrix for
- * the corresponding edges.
+ * The functions to obtain the relationship iterators are passed through
+ * the abegin and aend function pointers.
+ * Set the visited flag for all nodes visited.
  */
 static void
-visit_fcall_files(Fileid f, Call::const_fiterator_type (Call::*abegin)() const, Call::const_fiterator_type (Call::*aend)() const, int level, EdgeMatrix &edges)
+visit_fcall_files(Fileid f, FileCallGraph::const_iterator (*abegin)(Fileid), FileCallGraph::const_iterator (*aend)(Fileid), int level)
 {
 	if (level == 0)
 		return;
@@ -1682,22 +1885,9 @@ visit_fcall_files(Fileid f, Call::const_fiterator_type (Call::*abegin)() const,
 	if (DP())
 		cout << "Visiting " << f.get_fname() << endl;
 	f.set_visited();
-	/*
-	 * For every function in this file:
-	 * for every function associated with this function
-	 * set the edge and visit the corresponding files.
-	 */
-	for (FCallSet::const_iterator filefun = f.get_functions().begin(); filefun != f.get_functions().end(); filefun++) {
-		if (!(*filefun)->is_cfun())
-			continue;
-		for (Call::const_fiterator_type afun = ((*filefun)->*abegin)(); afun != ((*filefun)->*aend)(); afun++)
-			if ((*afun)->is_defined() && (*afun)->is_cfun()) {
-				Fileid f2((*afun)->get_definition().get_fileid());
-				edges[f.get_id()][f2.get_id()] = true;
-				if (!f2.is_visited())
-					visit_fcall_files(f2, abegin, aend, level - 1, edges);
-			}
-	}
+	for (FileCallGraph::const_iterator f2 = abegin(f); f2 != aend(f); f2++)
+		if (!f2->is_visited())
+			visit_fcall_files(*f2, abegin, aend, level - 1);
 }
 
 
@@ -1905,6 +2095,7 @@ set_options_page(FILE *fo, void *p)
 		return;
 	}
 	Option::set_all();
+	query_cache.clear();
 	if (Option::sfile_re_string->get().length()) {
 		sfile_re = CompiledRE(Option::sfile_re_string->get().c_str(), REG_EXTENDED);
 		if (!sfile_re.isCorrect()) {
@@ -2028,10 +2219,9 @@ single_function_graph()
  * Return true if the include/global/call graph is specified for a single file.
  * In this case caller will only show entries that have the visited flag set, so
  * set this flag as specified.
- * For function * call graphs also fill edges with a matrix indicating the dges to draw
  */
 static bool
-single_file_graph(char gtype, EdgeMatrix &edges)
+single_file_graph(char gtype)
 {
 	int id;
 	char *ltype = swill_getvar("n");
@@ -2072,14 +2262,12 @@ single_file_graph(char gtype, EdgeMatrix &edges)
 		}
 		break;
 	case 'F':		// Function call graph (control dependency)
-		int size = Fileid::max_id() + 1;
-		edges.insert(edges.begin(), size, vector<bool>(size, 0));
 		switch (*ltype) {
 		case 'D':
-			visit_fcall_files(fileid, &Call::call_begin, &Call::call_end, Option::cgraph_depth->get(), edges);
+			visit_fcall_files(fileid, &FileCallGraph::calls_begin, &FileCallGraph::calls_end, Option::cgraph_depth->get());
 			break;
 		case 'U':
-			visit_fcall_files(fileid, &Call::caller_begin, &Call::caller_end, Option::cgraph_depth->get(), edges);
+			visit_fcall_files(fileid, &FileCallGraph::callers_begin, &FileCallGraph::callers_end, Option::cgraph_depth->get());
 			break;
 		}
 		break;
@@ -2178,11 +2366,10 @@ fgraph_page(GraphDisplay *gd)
 		return;
 	}
 	bool all, only_visited;
-	EdgeMatrix edges;
 	bool empty_node = (Option::fgraph_show->get() == 'e');
 	if (gd->uses_swill) {
 		all = !!swill_getvar("all");		// Otherwise exclude read-only files
-		only_visited = single_file_graph(*gtype, edges);
+		only_visited = single_file_graph(*gtype);
 	}
 	else {
 		all = gd->all;
@@ -2201,26 +2388,6 @@ fgraph_page(GraphDisplay *gd)
 		break;
 	case 'F':		// Function call graph (control dependency)
 		gd->head("fgraph", "Function Call (Control) Dependency Graph", empty_node);
-		if (!only_visited) {
-			int size = Fileid::max_id() + 1;
-			edges.insert(edges.begin(), size, vector<bool>(size, 0));
-			// Fill the edges for all files
-			Fileid::clear_all_visited();
-			for (vector <Fileid>::iterator i = files.begin(); i != files.end(); i++) {
-				if (i->is_visited())
-					continue;
-				if (!all && i->get_readonly())
-					continue;
-				switch (*ltype) {
-				case 'D':
-					visit_fcall_files(*i, &Call::call_begin, &Call::call_end, Option::cgraph_depth->get(), edges);
-					break;
-				case 'U':
-					visit_fcall_files(*i, &Call::caller_begin, &Call::caller_end, Option::cgraph_depth->get(), edges);
-					break;
-				}
-			}
-		}
 		break;
 	default:
 		gd->head("fgraph", "Error", empty_node);
@@ -2264,29 +2431,41 @@ fgraph_page(GraphDisplay *gd)
 			}
 			break;
 		}
-		case 'F':		// Function call graph (control dependency)
-			for (vector <Fileid>::iterator j = files.begin(); j != files.end(); j++) {
+		case 'F': {		// Function call graph (control dependency)
+			FileCallGraph::const_iterator b, e;
+			switch (*ltype) {
+			case 'D':
+				b = FileCallGraph::calls_begin(*i);
+				e = FileCallGraph::calls_end(*i);
+				break;
+			case 'U':
+				b = FileCallGraph::callers_begin(*i);
+				e = FileCallGraph::callers_end(*i);
+				break;
+			default:
+				b = e = FileCallGraph::calls_end(*i);
+				break;
+			}
+			for (FileCallGraph::const_iterator j = b; j != e; j++) {
 				if (!all && j->get_readonly())
 					continue;
 				if (only_visited && !j->is_visited())
 					continue;
 				if (*i == *j)
 					continue;
-				if (DP())
-					cout << "Checking " << i->get_fname() << " - " << j->get_fname() << endl;
-				if (edges[i->get_id()][j->get_id()])
-					switch (*ltype) {
-					case 'D':
-						gd->edge(*j, *i);
-						break;
-					case 'U':
-						gd->edge(*i, *j);
-						break;
-					}
+				switch (*ltype) {
+				case 'D':
+					gd->edge(*j, *i);
+					break;
+				case 'U':
+					gd->edge(*i, *j);
+					break;
+				}
 				if (browse_only && count++ >= MAX_BROWSING_GRAPH_ELEMENTS)
 					goto end;
 			}
 			break;
+		}
 		case 'G':		// Global object def/ref graph (data dependency)
 			for (Fileidset::const_iterator j = i->glob_uses().begin(); j != i->glob_uses().end(); j++) {
 				if (!all && j->get_readonly())
@@ -2637,7 +2816,7 @@ index_page(FILE *of, void *data)
 	);
 
 
-	if (!browse_only)
+	if (!browse_only) {
 		fputs(
 			"<div class=\"mainblock\">\n"
 			"<h2>Operations</h2>"
@@ -2647,11 +2826,15 @@ index_page(FILE *of, void *data)
 			"<li> <a href=\"replacements.html\">Identifier replacements</a>\n"
 			"<li> <a href=\"funargrefs.html\">Function argument refactorings</a>\n"
 			"<li> <a href=\"sproject.html\">Select active project</a>\n"
-			"<li> <a href=\"about.html\">About CScout</a>\n"
+			"<li> <a href=\"about.html\">About CScout</a>\n", of);
+		if (Profile::is_enabled())
+			fputs("<li> <a href=\"profile.html\">Analysis profile</a>\n", of);
+		fputs(
 			"<li> <a href=\"save.html\">Save changes and continue</a>\n"
 			"<li> <a href=\"sexit.html\">Exit &mdash; saving changes</a>\n"
 			"<li> <a href=\"qexit.html\">Exit &mdash; ignore changes</a>\n"
 			"</ul></div>", of);
+	}
 	fputs("</td></tr></table>\n", of);
 	html_tail(of);
 }
@@ -2793,6 +2976,7 @@ fedit_page(FILE *of, void *p)
 	fprintf(of, "The editor should have started in a separate window");
 	html_tail(of);
 	modification_state = ms_hand_edit;
+	query_cache.clear();
 }
 
 void
@@ -2921,6 +3105,7 @@ xreplacements_page(FILE *of,  void *p)
 		}
 	}
 	cerr << endl;
+	query_cache.clear();
 	index_page(of, p);
 }
 
@@ -2966,6 +3151,7 @@ xfunargrefs_page(FILE *of,  void *p)
 		snprintf(varname, sizeof(varname), "a%p", i->first);
 		i->second.set_active(!!swill_getvar(varname));
 	}
+	query_cache.clear();
 	index_page(of, p);
 }
 
@@ -3079,17 +3265,17 @@ parse_acl()
 			in >> host;
 			if (ad == "A") {
 				cerr << "Allow from IP address " << host << endl;
-				swill_allow(host.c_str());
+				Dispatcher::allow(host);
 			} else if (ad == "D") {
 				cerr << "Deny from IP address " << host << endl;
-				swill_deny(host.c_str());
+				Dispatcher::deny(host);
 			} else
 				cerr << "Bad ACL specification " << ad << ' ' << host << endl;
 		}
 		in.close();
 	} else {
 		cerr << "No ACL found.  Only localhost access will be allowed." << endl;
-		swill_allow("127.0.0.1");
+		Dispatcher::allow("127.0.0.1");
 	}
 }
 
@@ -3198,6 +3384,130 @@ warning_report()
 	}
 }
 
+// Set xfile and metrics for each identifier
+static void
+ids_analyze()
+{
+	cerr << "Processing identifiers" << endl;
+	vector <IdProp::iterator> idv;
+	for (IdProp::iterator i = ids.begin(); i != ids.end(); i++)
+		idv.push_back(i);
+	vector <IdMetricsSummary> msum(Parallel::get_threads());
+	atomic <size_t> done(0);
+	size_t total = idv.size();
+	Parallel::for_each(total, [&](size_t n, unsigned t) {
+		IdProp::iterator i = idv[n];
+		Eclass *e = (*i).first;
+		IFSet ifiles = e->sorted_files();
+		(*i).second.set_xfile(ifiles.size() > 1);
+		// Update metrics
+		msum[t].add_unique_id(e);
+		// Only take the lock when there is a new percentage to show
+		size_t d = ++done;
+		if (d * 100 / total != (d - 1) * 100 / total) {
+			lock_guard <mutex> guard(output_lock);
+			progress(d, total);
+		}
+	});
+	for (vector <IdMetricsSummary>::const_iterator i = msum.begin(); i != msum.end(); i++)
+		id_msum += *i;
+	cerr << endl;
+}
+
+#ifndef WIN32
+// Return the name of the snapshot of the -U workspace fname's project i
+static string
+project_snapshot(const string &fname, int i)
+{
+	ostringstream s;
+	s << fname << '.' << i;
+	return s.str();
+}
+
+/*
+ * Process in child processes the projects that are not current,
+ * up to one per thread at a time.
+ * Return in the parent -1, and in a child the project it must process.
+ */
+static int
+process_projects(const vector <bool> &current)
+{
+	unsigned running = 0;
+	bool failed = false;
+	for (int i = 0; i < (int)current.size() || running > 0; ) {
+		int status;
+		if (i < (int)current.size() && current[i])
+			i++;
+		else if (i < (int)current.size() && running < Parallel::get_threads()) {
+			cerr << "Processing project " << i << " of the workspace" << endl;
+			pid_t pid = fork();
+			if (pid == 0)
+				return i;
+			if (pid == -1)
+				failed = true;
+			else
+				running++;
+			i++;
+		} else if (wait(&status) != -1) {
+			running--;
+			if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+				failed = true;
+		} else
+			running = 0;
+	}
+	if (failed)
+		/*
+		 * @error
+		 * A child process that processed a project of the
+		 * workspace specified with the -U option failed
+		 */
+		Error::error(E_FATAL, "Processing a project of the workspace failed", false);
+	return -1;
+}
+
+/*
+ * Bring up to date the snapshots of the projects of the -U workspace
+ * fname, processing again only the projects whose files have changed,
+ * and add the snapshots to the ones to load.
+ * Return in the parent -1, and in a child the project it must process.
+ */
+static int
+update_projects(const string &fname, const string &input, vector <string> &load_files)
+{
+	int nprojects = -1;
+	vector <bool> current;
+	int child;
+
+	for (int i = 0; access(project_snapshot(fname, i).c_str(), R_OK) == 0; i++) {
+		int n;
+		current.push_back(Snapshot::is_current(project_snapshot(fname, i), input, n));
+		if (current.back())
+			nprojects = n;
+	}
+
+	if (nprojects == -1) {
+		// The workspace changed; its first project gives their number
+		current.assign(1, false);
+		if ((child = process_projects(current)) != -1)
+			return child;
+		Snapshot::is_current(project_snapshot(fname, 0), input, nprojects);
+		current[0] = true;
+	}
+	// A workspace without projects is processed as one
+	nprojects = max(nprojects, 1);
+	current.resize(nprojects, false);
+	if ((child = process_projects(current)) != -1)
+		return child;
+
+	// Remove the snapshots of projects that no longer exist
+	for (int i = nprojects; unlink(project_snapshot(fname, i).c_str()) == 0; i++)
+		;
+	for (int i = 0; i < nprojects; i++)
+		load_files.push_back(project_snapshot(fname, i));
+	return -1;
+}
+#endif
+
 // Report usage information and exit
 static void
 usage(char *fname)
@@ -3209,7 +3519,7 @@ usage(char *fname)
 #endif
 		"-C|-c|-R|-d D|-d H|-E RE|-o|"
 		"-r|-s db|-v] "
-		"[-l file] "
+		"[-l file] [-P file] [-S file|-U file] [-w n/N] "
 
 #ifdef PICO_QL
 #define PICO_QL_OPTIONS "q"
@@ -3218,7 +3528,7 @@ usage(char *fname)
 #define PICO_QL_OPTIONS ""
 #endif
 
-		"[-p port] [-m spec] file\n"
+		"[-j n] [-p port] [-m spec] file | -L file ...\n"
 #ifndef WIN32
 		"\t-b\tRun in multiuser browse-only mode\n"
 #endif
@@ -3229,17 +3539,25 @@ usage(char *fname)
 		"\t-d H\tOutput the included files being processed on standard output\n"
 		"\t-E RE\tPrint preprocessed results on standard output and exit\n"
 		"\t\t(Will process file(s) matched by the regular expression)\n"
+		"\t-j n\tUse n threads for post-processing (default: one per CPU)\n"
+		"\t-L file\tLoad the workspace saved with -S instead of processing it\n"
+		"\t\t(Repeat to merge the partial workspaces of -w shards)\n"
 		"\t-l file\tSpecify access log file\n"
 		"\t-m spec\tSpecify identifiers to monitor (unsound)\n"
 		"\t-o\tCreate obfuscated versions of the processed files\n"
+		"\t-P file\tWrite a profile of the analysis phases to file (JSON)\n"
 		"\t-p port\tSpecify TCP port for serving the CScout web pages\n"
 		"\t\t(the port number must be in the range 1024-32767)\n"
 #ifdef PICO_QL
 		"\t-q\tProvide a PiCO_QL query interface\n"
 #endif
 		"\t-r\tGenerate an identifier and include file warning report\n"
+		"\t-S file\tSave the processed workspace to the specified file\n"
 		"\t-s db\tGenerate SQL output for the specified RDBMS\n"
+		"\t-U file\tLoad the -S workspace file, or update it if it is out of date\n"
 		"\t-v\tDisplay version and copyright information and exit\n"
+		"\t-w n/N\tProcess only shard n of N of the workspace's projects\n"
+		"\t\tand save it as a partial workspace with -S (requires -c)\n"
 		"\t-3\tEnable the handling of trigraph characters\n"
 		;
 	exit(1);
@@ -3256,9 +3574,15 @@ main(int argc, char *argv[])
 #endif
 
 	vector<string> call_graphs;
+	int nthreads = 0;		// One per CPU
+	const char *save_file = NULL;	// Workspace snapshot to save
+	vector <string> load_files;	// and to load
+	const char *update_file = NULL;	// Snapshot to load or save
+	int shard = 0, nshards = 0;	// Workspace shard to process
+	bool ctags = false;
 	Debug::db_read();
 
-	while ((c = getopt(argc, argv, "3bCcd:rvE:p:m:l:os:R:" PICO_QL_OPTIONS)) != EOF)
+	while ((c = getopt(argc, argv, "3bCcd:rvE:p:m:j:l:L:oP:s:S:U:R:w:" PICO_QL_OPTIONS)) != EOF)
 		switch (c) {
 		case '3':
 			Fchar::enable_trigraphs();
@@ -3278,6 +3602,7 @@ main(int argc, char *argv[])
 			break;
 		case 'C':
 			CTag::enable();
+			ctags = true;
 			break;
 		#ifdef PICO_QL
 		case 'q':
@@ -3315,6 +3640,13 @@ main(int argc, char *argv[])
 				usage(argv[0]);
 			monitor = IdQuery(optarg);
 			break;
+		case 'j':
+			if (!optarg)
+				usage(argv[0]);
+			nthreads = atoi(optarg);
+			if (nthreads < 1)
+				usage(argv[0]);
+			break;
 		case 'r':
 			if (process_mode)
 				usage(argv[0]);
@@ -3349,26 +3681,92 @@ main(int argc, char *argv[])
 			process_mode = pm_database;
 			db_engine = strdup(optarg);
 			break;
+		case 'S':
+			if (!optarg)
+				usage(argv[0]);
+			save_file = optarg;
+			break;
+		case 'L':
+			if (!optarg)
+				usage(argv[0]);
+			load_files.push_back(optarg);
+			break;
+		case 'U':
+			if (!optarg)
+				usage(argv[0]);
+			update_file = optarg;
+			break;
 		case 'R':
 			if (!optarg)
 				usage(argv[0]);
 			process_mode = pm_r_option;
 			call_graphs.push_back(string(optarg));
 			break;
+		case 'P':
+			if (!optarg)
+				usage(argv[0]);
+			Profile::enable(optarg);
+			break;
+		case 'w':
+			if (!optarg || sscanf(optarg, "%d/%d", &shard, &nshards) != 2 ||
+			    shard < 0 || shard >= nshards)
+				usage(argv[0]);
+			break;
 		case '?':
 			usage(argv[0]);
 		}
 
 
-	// We require exactly one argument
-	if (argv[optind] == NULL || argv[optind + 1] != NULL)
+	bool load_file = !load_files.empty();
+	if (load_file && argv[optind] != NULL)
+		usage(argv[0]);
+	if (!load_file && (argv[optind] == NULL || argv[optind + 1] != NULL))
+		// We require exactly one argument
+		usage(argv[0]);
+	if ((load_file || update_file || nshards) &&
+	    // A loaded workspace lacks the parsing state these require
+	    (ctags || process_mode == pm_preprocess ||
+	     process_mode == pm_obfuscation ||
+	     process_mode == pm_database))
+		usage(argv[0]);
+	if (update_file && (load_file || save_file || nshards))
+		usage(argv[0]);
+	// A shard's partial workspace is saved after parsing
+	if (nshards && (process_mode != pm_compile || !save_file || load_file))
 		usage(argv[0]);
 
+	Parallel::set_threads(nthreads);
+
+	string project_file;		// Snapshot of a -U project
+	if (update_file) {
+		int nprojects;
+		if (Snapshot::is_current(update_file, argv[optind], nprojects)) {
+			load_files.push_back(update_file);
+			load_file = true;
+		} else {
+			save_file = update_file;
+#ifndef WIN32
+			shard = update_projects(update_file, argv[optind], load_files);
+			if (shard == -1)
+				// Merge the projects' snapshots
+				load_file = true;
+			else {
+				// Process a single project in this child process
+				nshards = INT_MAX;
+				process_mode = pm_compile;
+				project_file = project_snapshot(update_file, shard);
+				save_file = project_file.c_str();
+			}
+#endif
+		}
+	}
+
 	if (process_mode != pm_compile && process_mode != pm_preprocess) {
 		if (!swill_init(portno)) {
 			cerr << "Couldn't initialize our web server on port " << portno << endl;
 			exit(1);
 		}
+		Dispatcher::init(portno);
 
 		Option::initialize();
 		options_load();
@@ -3378,33 +3776,63 @@ main(int argc, char *argv[])
 	if (db_engine) {
 		if (!Sql::setEngine(db_engine))
 			return 1;
-		cout << Sql::getInterface()->begin_commands();
-		workdb_schema(Sql::getInterface(), cout);
+		Sql *db = Sql::getInterface();
+		ostringstream schema;
+		schema << db->begin_commands();
+		workdb_schema(db, schema);
+		db->execute(cout, schema.str());
 	}
 
-	Project::set_current_project("unspecified");
+	if (load_file) {
+		for (vector <string>::const_iterator i = load_files.begin(); i != load_files.end(); i++) {
+			Profile::begin("load", *i);
+			input_file_id = Snapshot::load(*i);
+			Profile::end();
+		}
+		if (Snapshot::is_partial()) {
+			Profile::begin("unify");
+			Fileid::unify_identical_files();
+			Eclass::flatten_all();
+			Profile::end();
+		}
+	} else {
+		Project::set_current_project("unspecified");
+		if (nshards)
+			Pdtoken::set_shard(shard, nshards);
 
-	// Set the contents of the master file as immutable
-	Fileid fi = Fileid(argv[optind]);
-	fi.set_readonly(true);
+		// Set the contents of the master file as immutable
+		Fileid fi = Fileid(argv[optind]);
+		fi.set_readonly(true);
 
-	// Pass 1: process master file loop
-	Fchar::set_input(argv[optind]);
-	Error::set_parsing(true);
-	do
-		t.getnext();
-	while (t.get_code() != EOF);
-	Error::set_parsing(false);
+		// Pass 1: process master file loop
+		Fchar::set_input(argv[optind]);
+		Error::set_parsing(true);
+		do
+			t.getnext();
+		while (t.get_code() != EOF);
+		Error::set_parsing(false);
 
-	if (process_mode == pm_preprocess)
-		return 0;
+		if (process_mode == pm_preprocess)
+			return 0;
 
-	input_file_id = Fileid(argv[optind]);
+		input_file_id = Fileid(argv[optind]);
 
-	Fileid::unify_identical_files();
+		Profile::begin("unify");
+		Fileid::unify_identical_files();
+		Eclass::flatten_all();
+		Profile::end();
 
-	if (process_mode == pm_obfuscation)
-		return obfuscate();
+		if (nshards) {
+			// The merged shards are post-processed together
+			Profile::begin("save", save_file);
+			Snapshot::save(save_file, input_file_id, true);
+			Profile::end();
+			return 0;
+		}
+
+		if (process_mode == pm_obfuscation)
+			return obfuscate();
+	}
 
 	// Pass 2: Create web pages
 	files = Fileid::files(true);
@@ -3423,40 +3851,79 @@ main(int argc, char *argv[])
 		swill_handle("sexit.html", write_quit_page, "exit");
 		swill_handle("save.html", write_quit_page, 0);
 		swill_handle("qexit.html", quit_page, 0);
+
+		// Pages changing the state are served in order, in this process
+		Dispatcher::add_state_page("xreplacements.html");
+		Dispatcher::add_state_page("xfunargrefs.html");
+		Dispatcher::add_state_page("soptions.html");
+		Dispatcher::add_state_page("save_options.html");
+		Dispatcher::add_state_page("sexit.html");
+		Dispatcher::add_state_page("save.html");
+		Dispatcher::add_state_page("qexit.html");
+		Dispatcher::add_state_page("setproj.html");
+		Dispatcher::add_state_page("fedit.html");
+		Dispatcher::add_state_page("id.html", "sname");
+		Dispatcher::add_state_page("fun.html", "ncall");
 	}
 
+	// A partial workspace has only been parsed
+	bool analyzed = load_file && !Snapshot::is_partial();
+
 	// Populate the EC identifier member and the directory tree
-	for (vector <Fileid>::iterator i = files.begin(); i != files.end(); i++) {
-		file_analyze(*i);
-		dir_add_file(*i);
-	}
+	Profile::begin("files_analyze");
+	if (analyzed)
+		for (vector <Fileid>::const_iterator i = files.begin(); i != files.end(); i++)
+			dir_add_file(*i);
+	else
+		files_analyze(files);
+	Profile::end();
 
 	// Update file and function metrics
+	Profile::begin("summarize");
 	file_msum.summarize_files();
 	fun_msum.summarize_functions();
+	Profile::end();
 
-	// Set runtime file dependencies
-	GlobObj::set_file_dependencies();
+	if (process_mode != pm_compile) {
+		Profile::begin("file_call_graph");
+		FileCallGraph::build(files);
+		Profile::end();
+	}
 
-	// Set xfile and  metrics for each identifier
-	cerr << "Processing identifiers" << endl;
-	for (IdProp::iterator i = ids.begin(); i != ids.end(); i++) {
-		progress(i, ids);
-		Eclass *e = (*i).first;
-		IFSet ifiles = e->sorted_files();
-		(*i).second.set_xfile(ifiles.size() > 1);
-		// Update metrics
-		id_msum.add_unique_id(e);
+	if (!analyzed) {
+		// Set runtime file dependencies
+		Profile::begin("file_dependencies");
+		GlobObj::set_file_dependencies();
+		Profile::end();
+
+		// Set xfile and  metrics for each identifier
+		Profile::begin("ids_analyze");
+		ids_analyze();
+		Profile::end();
+	}
+
+	if (save_file) {
+		Profile::begin("save", save_file);
+		Snapshot::save(save_file, input_file_id);
+		Profile::end();
 	}
-	cerr << endl;
 
 	if (DP())
 		cout << "Size " << file_msum.get_total(Metrics::em_nchar) << endl;
 
 	if (Sql::getInterface()) {
+		Profile::begin("sql_dump");
 		workdb_rest(Sql::getInterface(), cout);
 		Call::dumpSql(Sql::getInterface(), cout);
-		cout << Sql::getInterface()->end_commands();
+		Sql *db = Sql::getInterface();
+		db->flush(cout);
+		if (db->create_indexes()) {
+			ostringstream indexes;
+			workdb_indexes(db, indexes);
+			db->execute(cout, indexes.str());
+		}
+		db->execute(cout, db->end_commands());
+		Profile::end();
 #ifdef LINUX_STAT_MONITOR
 		char buff[100];
 		sprintf(buff, "cat /proc/%u/stat >%u.stat", getpid(), getpid());
@@ -3502,6 +3969,10 @@ main(int argc, char *argv[])
 		swill_handle("setproj.html", set_project_page, NULL);
 		swill_handle("logo.png", logo_page, NULL);
 		swill_handle("index.html", (void (*)(FILE *, void *))((char *)index_page), 0);
+		if (Profile::is_enabled()) {
+			swill_handle("profile.html", Profile::html_page, NULL);
+			swill_handle("profile.json", Profile::json_page, NULL);
+		}
 	}
 
 
@@ -3526,7 +3997,6 @@ main(int argc, char *argv[])
 	if (pico_ql) {
 		pico_ql_register(&files, "files");
 		pico_ql_register(&Identifier::ids, "ids");
-		pico_ql_register(&Tokid::tm, "tm");
 		pico_ql_register(&Call::functions(), "fun_map");
 		while (pico_ql_serve(portno))
 			;
@@ -3547,16 +4017,20 @@ main(int argc, char *argv[])
 		return (0);
 	if (DP())
 		cout  << "Tokid EC map size is " << Tokid::map_size() << endl;
+	Profile::begin("name_index");
+	index_names();
+	Profile::end();
 	// Serve web pages
 	if (!must_exit)
 		cerr << "CScout is now ready to serve you at http://localhost:" << portno << endl;
 	if (browse_only)
-		swill_setfork();
+		Dispatcher::set_fork_all();
 	while (!must_exit)
-		swill_serve();
+		Dispatcher::serve();
 
 #ifdef NODE_USE_PROFILE
 	cout << "Type node count = " << Type_node::get_count() << endl;
+	Pool::report(cout);
 #endif
 	return (0);
 }
@@ -3597,9 +4071,9 @@ garbage_collect(Fileid root)
 		}
 
 		const string &fname = fi.get_path();
-		fifstream in;
+		fbstream in;
 
-		in.open(fname.c_str(), ios::binary);
+		in.open(fi);
 		if (in.fail()) {
 			perror(fname.c_str());
 			exit(1);
@@ -3612,10 +4086,9 @@ garbage_collect(Fileid root)
 			ti = Tokid(fi, in.tellg());
 			if ((val = in.get()) == EOF)
 				break;
-			mapTokidEclass::iterator ei = ti.find_ec();
-			if (ei != ti.end_ec()) {
+			Eclass *ec = ti.check_ec();
+			if (ec != NULL) {
 				sum++;
-				Eclass *ec = ei->second;
 				IdPropElem ec_id(ec, Identifier());
 				if (!monitor.eval(ec_id)) {
 					count++;
@@ -128,10 +128,10 @@ unescape_char(const string& s, string::const_iterator& si)
 }
 
 // Create the map from identifiers to keyword token values
-static map<string,int> &
+static mapKeyword &
 make_keymap()
 {
-	static map<string,int> m;
+	static mapKeyword m;
 
 	m["auto"] = AUTO; m["double"] = DOUBLE; m["int"] = INT;
 	m["struct"] = STRUCT; m["break"] = BREAK; m["else"] = ELSE;
@@ -184,7 +184,7 @@ make_keymap()
 }
 
 // Map from identifiers to keyword token values
-static map<string,int>& keymap = make_keymap();
+static mapKeyword& keymap = make_keymap();
 
 static int parse_lex_real();
 
@@ -276,7 +276,7 @@ parse_lex_real()
 {
 	int c;
 	Id const *id;
-	map<string,int>::const_iterator ik;
+	mapKeyword::const_iterator ik;
 	extern YYSTYPE parse_lval;
 	extern bool parse_yacc_defs;
 
@@ -28,6 +28,7 @@
 
 #include <string>
 #include <map>
+#include <unordered_map>
 
 #include "token.h"
 #include "pdtoken.h"
@@ -36,7 +37,7 @@ using namespace std;
 
 char unescape_char(const string& s, string::const_iterator& si);
 
-typedef map<string, int> mapKeyword;
+typedef unordered_map<string, int> mapKeyword;
 
 class Ctoken: public Token {
 private:
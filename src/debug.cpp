@@ -31,11 +31,13 @@
 
 bool Debug::enabled;
 set<Debug> Debug::dp;		// Enabled debug points
+unsigned Debug::generation = 1;	// Incremented when dp changes
 
 void
 Debug::db_set(const string fname, int line)
 {
 	dp.insert(Debug(fname, line));
+	generation++;
 	enabled = true;
 }
 
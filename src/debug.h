@@ -38,9 +38,32 @@ private:
 
 	static set<Debug> dp;		// Enabled debug points
 	static bool enabled;		// Global enable variable
+	static unsigned generation;	// Incremented when dp changes
 public:
 	Debug(const string f, int l) : fname(f), line(l) {};
 
+	/*
+	 * The state of a debugpoint() call site.  Looking up dp for
+	 * every call would make tracing large inputs unbearably slow,
+	 * so each site caches its setting until dp changes.
+	 */
+	class Site {
+	private:
+		const char *fname;
+		int line;
+		unsigned generation;	// Of dp when set was computed
+		bool set;
+	public:
+		Site(const char *f, int l) : fname(f), line(l), generation(0), set(false) {}
+		bool is_set() {
+			if (generation != Debug::generation) {
+				set = is_db_set(fname, line);
+				generation = Debug::generation;
+			}
+			return set;
+		}
+	};
+
 	static inline bool is_db_set(const string &fname, int line);
 	static void db_set(string fname, int line);
 	static void db_read();
@@ -51,7 +74,9 @@ public:
 #ifdef NO_DP
 #define DP() 0
 #else
-#define DP() (Debug::is_enabled() && Debug::is_db_set((const string)__FILE__, __LINE__))
+// The lambda gives each call site its own static Site
+#define DP() (Debug::is_enabled() && \
+	[]() -> bool { static Debug::Site site(__FILE__, __LINE__); return site.is_set(); }())
 #endif
 
 inline bool
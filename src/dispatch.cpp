@@ -0,0 +1,391 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * For documentation read the corresponding .h file
+ *
+ */
+
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+#include <thread>
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+
+#ifndef WIN32
+#include <csignal>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#endif
+
+#include "swill.h"
+
+#include "visitmark.h"
+#include "dispatch.h"
+
+int Dispatcher::client_socket = -1;
+int Dispatcher::swill_socket = -1;
+bool Dispatcher::fork_all;
+unsigned Dispatcher::children;
+map <string, string> Dispatcher::state_pages;
+vector <string> Dispatcher::allowed, Dispatcher::denied;
+vector <Dispatcher::Pending> Dispatcher::pending;
+
+// Longest request line we accept
+static const string::size_type max_request = 1024 * 1024;
+// Seconds to wait for a client's request line
+static const int request_timeout = 30;
+
+void
+Dispatcher::allow(const string &ip)
+{
+	if (client_socket == -1)
+		swill_allow(ip.c_str());
+	else
+		allowed.push_back(ip);
+}
+
+void
+Dispatcher::deny(const string &ip)
+{
+	if (client_socket == -1)
+		swill_deny(ip.c_str());
+	else
+		denied.push_back(ip);
+}
+
+void
+Dispatcher::set_fork_all()
+{
+	if (client_socket == -1)
+		swill_setfork();
+	else
+		fork_all = true;
+}
+
+/*
+ * Apply the rules SWILL follows: a matching allowed entry gives
+ * access, and without allowed entries access is given unless a
+ * denied entry matches.
+ */
+bool
+Dispatcher::is_allowed(const string &ip)
+{
+	for (vector <string>::const_iterator i = allowed.begin(); i != allowed.end(); i++)
+		if (ip.compare(0, i->length(), *i) == 0)
+			return true;
+	if (!allowed.empty())
+		return false;
+	for (vector <string>::const_iterator i = denied.begin(); i != denied.end(); i++)
+		if (ip.compare(0, i->length(), *i) == 0)
+			return false;
+	return true;
+}
+
+bool
+Dispatcher::changes_state(const string &req)
+{
+	string::size_type sp = req.find(' ');
+	if (sp == string::npos || req.compare(0, sp, "GET") != 0)
+		return true;
+	string::size_type begin = req.find_first_not_of('/', sp + 1);
+	string::size_type end = req.find_first_of(" \r\n", begin);
+	if (begin == string::npos || end == string::npos)
+		return true;
+	string target(req, begin, end - begin);
+	string::size_type q = target.find('?');
+	map <string, string>::const_iterator page = state_pages.find(target.substr(0, q));
+	if (page == state_pages.end())
+		return false;
+	if (page->second.empty())
+		return true;
+	// Look for the variable among the query's names
+	while (q != string::npos) {
+		string::size_type next = target.find('&', q + 1);
+		string name(target, q + 1, target.find_first_of("=&", q + 1) - q - 1);
+		if (name == page->second)
+			return true;
+		q = next;
+	}
+	return false;
+}
+
+#ifndef WIN32
+// Write to fd all n bytes of buf; return false on failure
+static bool
+write_all(int fd, const char *buf, size_t n)
+{
+	while (n > 0) {
+		ssize_t w = write(fd, buf, n);
+		if (w < 0 && errno == EINTR)
+			continue;
+		if (w <= 0)
+			return false;
+		buf += w;
+		n -= w;
+	}
+	return true;
+}
+
+bool
+Dispatcher::read_request(Pending &p)
+{
+	char buf[4096];
+
+	ssize_t n = read(p.fd, buf, sizeof(buf));
+	if (n <= 0)
+		return false;
+	p.head.append(buf, n);
+	return p.head.length() <= max_request;
+}
+
+bool
+Dispatcher::listen_private()
+{
+	struct sockaddr_in a;
+	memset(&a, 0, sizeof(a));
+	a.sin_family = AF_INET;
+	a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	a.sin_port = 0;
+
+	int s = socket(AF_INET, SOCK_STREAM, 0);
+	if (s == -1)
+		return false;
+	if (bind(s, (struct sockaddr *)&a, sizeof(a)) == -1 ||
+	    listen(s, 1) == -1 ||
+	    dup2(s, swill_socket) == -1) {
+		close(s);
+		return false;
+	}
+	close(s);
+	return true;
+}
+
+void
+Dispatcher::relay(int c, const string &head)
+{
+	struct sockaddr_storage a;
+	socklen_t len = sizeof(a);
+	int s = socket(AF_INET, SOCK_STREAM, 0);
+	if (s == -1 ||
+	    getsockname(swill_socket, (struct sockaddr *)&a, &len) == -1 ||
+	    connect(s, (struct sockaddr *)&a, len) == -1) {
+		perror("Unable to relay web request");
+		if (s != -1)
+			close(s);
+		close(c);
+		return;
+	}
+
+	// Copy the request to SWILL and its response back to the client
+	thread pump([c, s, &head]() {
+		struct pollfd p[2];
+		char buf[16384];
+		bool client_ok = write_all(s, head.data(), head.length());
+
+		p[0].fd = c;
+		p[1].fd = s;
+		p[0].events = p[1].events = POLLIN;
+		if (!client_ok) {
+			shutdown(s, SHUT_WR);
+			p[0].fd = -1;
+		}
+		for (;;) {
+			if (poll(p, 2, -1) == -1) {
+				if (errno == EINTR)
+					continue;
+				break;
+			}
+			if (p[0].revents) {
+				ssize_t n = read(c, buf, sizeof(buf));
+				if (n <= 0 || !write_all(s, buf, n)) {
+					// The request has been sent
+					shutdown(s, SHUT_WR);
+					p[0].fd = -1;
+				}
+			}
+			if (p[1].revents) {
+				ssize_t n = read(s, buf, sizeof(buf));
+				if (n <= 0)
+					break;
+				// Keep reading, so that SWILL can finish, even if the client left
+				if (client_ok)
+					client_ok = write_all(c, buf, n);
+			}
+		}
+	});
+	VisitRequest::begin();
+	swill_serve();
+	pump.join();
+	close(s);
+	close(c);
+}
+
+void
+Dispatcher::wait_children()
+{
+	while (children > 0)
+		if (waitpid(-1, NULL, 0) == -1)
+			children = 0;
+		else
+			children--;
+}
+#endif
+
+bool
+Dispatcher::init(int port)
+{
+#ifdef WIN32
+	return false;
+#else
+	// Find SWILL's socket listening on the port
+	for (int fd = 0; fd < FD_SETSIZE; fd++) {
+		struct sockaddr_storage a;
+		socklen_t len = sizeof(a);
+		int listening = 0;
+		socklen_t llen = sizeof(listening);
+		if (getsockname(fd, (struct sockaddr *)&a, &len) == 0 &&
+		    a.ss_family == AF_INET &&
+		    ntohs(((struct sockaddr_in *)&a)->sin_port) == port &&
+		    getsockopt(fd, SOL_SOCKET, SO_ACCEPTCONN, &listening, &llen) == 0 &&
+		    listening) {
+			swill_socket = fd;
+			break;
+		}
+	}
+	if (swill_socket == -1)
+		return false;
+	// Keep the port's socket, and have SWILL accept the relayed requests
+	if ((client_socket = dup(swill_socket)) == -1)
+		return false;
+	if (!listen_private()) {
+		close(client_socket);
+		client_socket = -1;
+		return false;
+	}
+	swill_allow("127.0.0.1");
+	signal(SIGPIPE, SIG_IGN);
+	signal(SIGCHLD, SIG_DFL);
+	return true;
+#endif
+}
+
+void
+Dispatcher::serve()
+{
+#ifdef WIN32
+	swill_serve();
+#else
+	if (client_socket == -1) {
+		swill_serve();
+		return;
+	}
+
+	// Collect the forked processes that have completed their work
+	while (children > 0 && waitpid(-1, NULL, WNOHANG) > 0)
+		children--;
+
+	/*
+	 * Wait for a new connection, or for the request lines of the
+	 * pending ones, so that a slow client does not hold up the others.
+	 */
+	vector <struct pollfd> p(pending.size() + 1);
+	time_t now = time(NULL);
+	int timeout = -1;
+	p[0].fd = client_socket;
+	p[0].events = POLLIN;
+	for (vector <Pending>::size_type i = 0; i < pending.size(); i++) {
+		p[i + 1].fd = pending[i].fd;
+		p[i + 1].events = POLLIN;
+		int left = pending[i].deadline > now ? (pending[i].deadline - now) * 1000 : 0;
+		if (timeout == -1 || left < timeout)
+			timeout = left;
+	}
+	if (poll(&p[0], p.size(), timeout) == -1)
+		return;
+
+	vector <Pending> ready, waiting;
+	now = time(NULL);
+	for (vector <Pending>::size_type i = 0; i < pending.size(); i++) {
+		Pending &r = pending[i];
+		if (p[i + 1].revents && !read_request(r))
+			close(r.fd);
+		else if (r.head.find('\n') != string::npos)
+			ready.push_back(r);
+		else if (r.deadline <= now)
+			close(r.fd);
+		else
+			waiting.push_back(r);
+	}
+	pending = waiting;
+
+	if (p[0].revents) {
+		struct sockaddr_in a;
+		socklen_t len = sizeof(a);
+		int c = accept(client_socket, (struct sockaddr *)&a, &len);
+		if (c != -1) {
+			if (is_allowed(inet_ntoa(a.sin_addr)))
+				pending.push_back(Pending(c, now + request_timeout));
+			else
+				close(c);
+		}
+	}
+
+	for (vector <Pending>::const_iterator i = ready.begin(); i != ready.end(); i++)
+		dispatch(i->fd, i->head);
+#endif
+}
+
+#ifndef WIN32
+void
+Dispatcher::dispatch(int c, const string &head)
+{
+	if (fork_all || !changes_state(head)) {
+		// Avoid writing the pending output also in the child
+		cout.flush();
+		fflush(NULL);
+		pid_t pid = fork();
+		if (pid == 0) {
+			close(client_socket);
+			for (vector <Pending>::const_iterator i = pending.begin(); i != pending.end(); i++)
+				close(i->fd);
+			if (listen_private())
+				relay(c, head);
+			fflush(NULL);
+			_exit(0);
+		}
+		if (pid != -1) {
+			close(c);
+			children++;
+			return;
+		}
+	}
+	// Serve the request here, after the ones being served
+	wait_children();
+	relay(c, head);
+}
+#endif
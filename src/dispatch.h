@@ -0,0 +1,105 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * A dispatcher of the web requests served through SWILL.
+ * SWILL keeps the request being served in process-wide variables,
+ * so its handlers can not run concurrently in one process.
+ * The dispatcher therefore accepts the connections on the web
+ * server's port itself, and reads the request line to find the page
+ * requested.  Pages that only read the workspace are served in a
+ * forked process, so that a slow page does not hold up the others.
+ * Pages that change the workspace, the options, or the program's
+ * state are served in the main process, one at a time, after
+ * the pages already being served have been completed.
+ * In both cases SWILL serves the request through a private loopback
+ * connection, to which the dispatcher relays the client's data.
+ * As SWILL then only sees local connections, the dispatcher also
+ * applies the access control list.
+ *
+ * Include synopsis:
+ * #include <ctime>
+ * #include <map>
+ * #include <string>
+ * #include <vector>
+ *
+ */
+
+#ifndef DISPATCH_
+#define DISPATCH_
+
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class Dispatcher {
+private:
+	static int client_socket;	// Socket accepting the clients' connections
+	static int swill_socket;	// SWILL's listening socket
+	static bool fork_all;		// Serve all pages in forked processes
+	static unsigned children;	// Forked processes still serving
+	// Pages that change the state, when given the mapped variable
+	static map <string, string> state_pages;
+	static vector <string> allowed, denied;	// Access control list
+	// A connection whose request line is being read
+	struct Pending {
+		int fd;			// Client's socket
+		string head;		// Data read so far
+		time_t deadline;	// Time by which the line must arrive
+		Pending(int f, time_t d) : fd(f), deadline(d) {}
+	};
+	static vector <Pending> pending;	// Connections being read
+
+	// Return true if the client at address ip may connect
+	static bool is_allowed(const string &ip);
+	// Return true if the request line req must be served in order
+	static bool changes_state(const string &req);
+	// Read the data of p; return false if it must be dropped
+	static bool read_request(Pending &p);
+	// Serve the request of the client on c, starting with head
+	static void dispatch(int c, const string &head);
+	// Make SWILL listen on a new private loopback socket
+	static bool listen_private();
+	// Have SWILL serve the request of the client on c, starting with head
+	static void relay(int c, const string &head);
+	// Wait for the forked processes to exit
+	static void wait_children();
+public:
+	/*
+	 * Take over the connections of the SWILL server listening on
+	 * port; return false if this is not possible, in which case
+	 * requests are served by SWILL alone.
+	 */
+	static bool init(int port);
+	// Serve every request in a forked process (for browse-only mode)
+	static void set_fork_all();
+	// Register page as changing the state, always or when var is given
+	static void add_state_page(const string &page, const string &var = "") {
+		state_pages[page] = var;
+	}
+	// Allow or deny access from IP addresses starting with ip
+	static void allow(const string &ip);
+	static void deny(const string &ip);
+	// Serve a single request
+	static void serve();
+};
+
+#endif /* DISPATCH_ */
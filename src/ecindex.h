@@ -0,0 +1,181 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * A per-file index from file offsets to equivalence classes.
+ * Every file keeps one of these in its Filedetails; together they
+ * replace a single workspace-wide Tokid to Eclass map.
+ *
+ * The offsets are grouped into pages of 64 positions.  Each page
+ * has a bitmap of the positions that have an EC and a packed vector
+ * holding these ECs in offset order.  An offset's EC is located
+ * in constant time through its page number and the population
+ * count of the bitmap bits that precede it.
+ *
+ * Include synopsis:
+ * #include <vector>
+ * #include <bitset>
+ *
+ * #include "cpp.h"
+ *
+ */
+
+#ifndef ECINDEX_
+#define ECINDEX_
+
+#include <vector>
+#include <bitset>
+
+using namespace std;
+
+#include "cpp.h"
+
+class Eclass;
+
+class EcIndex {
+private:
+	typedef unsigned long long page_map;
+	enum { page_bits = 6, page_size = 1 << page_bits };
+	struct Page {
+		page_map present;		// Offsets having an EC
+		vector <Eclass *> ecs;		// Their ECs, ordered by offset
+		Page() : present(0) {}
+	};
+	vector <Page> pages;			// Indexed by offset / page_size
+	size_t count;				// Number of stored ECs
+
+	// Return the position in p.ecs of the EC stored at bit
+	static int slot(const Page &p, int bit) {
+		return (int)bitset<page_size>(p.present & ((1ULL << bit) - 1)).count();
+	}
+public:
+	EcIndex() : count(0) {}
+	// Return the EC stored at offset o, or NULL if none
+	inline Eclass *find(cs_offset_t o) const;
+	/*
+	 * Return the EC stored at the highest offset not greater than o,
+	 * and set start to that offset; return NULL if there is none
+	 */
+	inline Eclass *find_preceding(cs_offset_t o, cs_offset_t &start) const;
+	// Set the EC at offset o to ec; return true if there was none
+	inline bool set(cs_offset_t o, Eclass *ec);
+	// Remove the EC at offset o; return true if there was one
+	inline bool erase(cs_offset_t o);
+	// Number of offsets having an EC
+	size_t size() const { return count; }
+	// Call f(offset, ec) for all stored ECs in offset order
+	template <typename F> void for_each(F f) const;
+	// Remove all entries
+	void clear() { pages.clear(); count = 0; }
+};
+
+inline Eclass *
+EcIndex::find(cs_offset_t o) const
+{
+	size_t pn = (size_t)(o >> page_bits);
+	if (pn >= pages.size())
+		return NULL;
+	const Page &p = pages[pn];
+	int bit = (int)(o & (page_size - 1));
+	if (!(p.present & (1ULL << bit)))
+		return NULL;
+	return p.ecs[slot(p, bit)];
+}
+
+inline Eclass *
+EcIndex::find_preceding(cs_offset_t o, cs_offset_t &start) const
+{
+	if (pages.empty())
+		return NULL;
+	size_t pn = (size_t)(o >> page_bits);
+	page_map mask = ~0ULL;		// Bits of the page to consider
+	if (pn >= pages.size())
+		pn = pages.size() - 1;
+	else {
+		int bit = (int)(o & (page_size - 1));
+		if (bit < page_size - 1)
+			mask = (1ULL << (bit + 1)) - 1;
+	}
+	for (;;) {
+		const Page &p = pages[pn];
+		page_map m = p.present & mask;
+		if (m) {
+			int bit = page_size - 1;
+			while (!(m & (1ULL << bit)))
+				bit--;
+			start = (cs_offset_t)(pn * page_size + bit);
+			return p.ecs[slot(p, bit)];
+		}
+		if (pn == 0)
+			return NULL;
+		pn--;
+		mask = ~0ULL;
+	}
+}
+
+inline bool
+EcIndex::set(cs_offset_t o, Eclass *ec)
+{
+	size_t pn = (size_t)(o >> page_bits);
+	if (pn >= pages.size())
+		pages.resize(pn + 1);
+	Page &p = pages[pn];
+	int bit = (int)(o & (page_size - 1));
+	int s = slot(p, bit);
+	if (p.present & (1ULL << bit)) {
+		p.ecs[s] = ec;
+		return false;
+	}
+	p.present |= (1ULL << bit);
+	p.ecs.insert(p.ecs.begin() + s, ec);
+	count++;
+	return true;
+}
+
+inline bool
+EcIndex::erase(cs_offset_t o)
+{
+	size_t pn = (size_t)(o >> page_bits);
+	if (pn >= pages.size())
+		return false;
+	Page &p = pages[pn];
+	int bit = (int)(o & (page_size - 1));
+	if (!(p.present & (1ULL << bit)))
+		return false;
+	p.ecs.erase(p.ecs.begin() + slot(p, bit));
+	p.present &= ~(1ULL << bit);
+	if (!p.present)
+		vector <Eclass *>().swap(p.ecs);	// Release the page's storage
+	count--;
+	return true;
+}
+
+template <typename F>
+void
+EcIndex::for_each(F f) const
+{
+	for (size_t pn = 0; pn < pages.size(); pn++) {
+		const Page &p = pages[pn];
+		int s = 0;
+		for (int bit = 0; bit < page_size; bit++)
+			if (p.present & (1ULL << bit))
+				f((cs_offset_t)(pn * page_size + bit), p.ecs[s++]);
+	}
+}
+
+#endif /* ECINDEX_ */
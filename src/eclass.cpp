@@ -48,28 +48,87 @@
 #include "pdtoken.h"
 #include "eclass.h"
 
+unsigned long Eclass::count;		// Number of classes
+
 // Remove references to the equivalence class from the tokid map
 // Should be called when we delete the ec for good
 void
 Eclass::remove_from_tokid_map()
 {
+	flatten();
 	if (DP())
 		cout << "Destructing " << *this << "\n";
 	for (setTokid::const_iterator i = members.begin(); i != members.end(); i++)
 		(*i).erase_ec(this);
 }
 
+void
+Eclass::flatten()
+{
+	if (child == NULL)
+		return;
+	vector <Tokid> moved;
+	moved.reserve(merged);
+	vector <Eclass *> pending(1, child);
+	while (!pending.empty()) {
+		Eclass *e = pending.back();
+		pending.pop_back();
+		if (e->sibling)
+			pending.push_back(e->sibling);
+		if (e->child)
+			pending.push_back(e->child);
+		for (setTokid::const_iterator i = e->members.begin(); i != e->members.end(); i++) {
+			i->set_ec(this);
+			moved.push_back(*i);
+		}
+		delete e;
+	}
+	members.merge(moved);
+	child = NULL;
+	merged = 0;
+}
+
+void
+Eclass::flatten_all()
+{
+	vector <Eclass *> roots;
+	for (int i = 0; i <= Fileid::max_id(); i++)
+		Fileid(i).get_ec_index().for_each([&roots](cs_offset_t, Eclass *ec) {
+			Eclass *root = ec->find();
+			if (root->child && (roots.empty() || roots.back() != root))
+				roots.push_back(root);
+		});
+	// Flattening a root again does nothing
+	for (vector <Eclass *>::iterator i = roots.begin(); i != roots.end(); i++)
+		(*i)->flatten();
+}
+
 Eclass *
 merge(Eclass *a, Eclass *b)
+{
+	a = a->find();
+	b = b->find();
+	if (a == b)
+		return a;
+	Eclass *r = unite(a, b);
+	if (!Pdtoken::skipping())
+		r->set_attribute(Project::get_current_projid());
+	return r;
+}
+
+Eclass *
+unite(Eclass *a, Eclass *b)
 {
 	Eclass *little, *large;
+	a = a->find();
+	b = b->find();
 	if (a == b)
 		return a;
 	if (DP())
 		cout << "merge a=" << a << *a << " b=" << b << *b << "\n";
 	csassert(a->len == b->len);
-	// It is more efficient to append the little at the end of the large one
-	if (a->members.size() > b->members.size()) {
+	// Link the smaller tree under the larger one
+	if (a->get_size() > b->get_size()) {
 		large = a;
 		little = b;
 	} else {
@@ -77,10 +136,15 @@ merge(Eclass *a, Eclass *b)
 		little = a;
 	}
 
-	for (setTokid::const_iterator i = little->members.begin(); i != little->members.end(); i++)
-		large->add_tokid(*i);
+	little->parent = large;
+	little->sibling = large->child;
+	large->child = little;
+	large->merged += little->get_size();
+	/*
+	 * The read-only attribute of the little class's members
+	 * is part of its attributes.
+	 */
 	large->merge_attributes(little);
-	delete little;
 	return (large);
 }
 
@@ -93,9 +157,15 @@ Eclass::split(int pos)
 	if (DP())
 		cout << "Split " << this << " pos=" << pos << *this;
 	csassert(oldchars < len);
+	flatten();
 	Eclass *e = new Eclass(len - oldchars);
-	for (setTokid::const_iterator i = members.begin(); i != members.end(); i++)
-		e->add_tokid(*i + oldchars);
+	// Moving all members by the same amount retains their order
+	e->members.reserve(members.size());
+	for (setTokid::const_iterator i = members.begin(); i != members.end(); i++) {
+		Tokid t(*i + oldchars);
+		e->members.insert(t);
+		t.set_ec(e);
+	}
 	e->attr = attr;
 	len = oldchars;
 	if (DP()) {
@@ -140,9 +210,15 @@ Eclass::sorted_files()
 {
 	set <Fileid, fname_order> r;
 	setTokid::const_iterator i;
+	Fileid prev(-1);
 
+	flatten();
+	// Members are ordered by file, so add each file once
 	for (i = members.begin(); i != members.end(); i++)
-		r.insert(i->get_fileid());
+		if (i->get_fileid() != prev) {
+			prev = i->get_fileid();
+			r.insert(prev);
+		}
 	return (r);
 }
 
@@ -153,6 +229,7 @@ Eclass::functions()
 	set <Call *> r;
 	setTokid::const_iterator i;
 
+	flatten();
 	for (i = members.begin(); i != members.end(); i++) {
 		FCallSet fc(i->get_fileid().get_functions());
 		for (FCallSet::const_iterator j = fc.begin(); j != fc.end(); j++)
@@ -170,6 +247,7 @@ Eclass::is_unused()
 {
 	if (attr.get_attribute(is_declared_unused))
 		return (false);		// Programmer knows it
+	flatten();
 	if (members.size() == 1)
 		return (true);
 	// More complex case: see if all the members come from unified identical files
@@ -27,27 +27,84 @@
 
 #include <deque>
 #include <vector>
+#include <algorithm>
+#include <iterator>
 
 using namespace std;
 
 #include "attr.h"
 #include "tokid.h"
 #include "tokmap.h"
+#include "pool.h"
 
-typedef set<Tokid> setTokid;
+/*
+ * The members of an equivalence class, kept as a sorted vector.
+ * Tokids are mostly added in increasing order, so an insertion
+ * is typically an append.
+ */
+class setTokid {
+private:
+	vector <Tokid> v;
+public:
+	typedef vector <Tokid>::const_iterator const_iterator;
+	typedef vector <Tokid>::size_type size_type;
+	const_iterator begin() const { return v.begin(); }
+	const_iterator end() const { return v.end(); }
+	size_type size() const { return v.size(); }
+	bool empty() const { return v.empty(); }
+	void reserve(size_type n) { v.reserve(n); }
+	// Add t, if it is not already a member
+	void insert(Tokid t) {
+		if (v.empty() || v.back() < t) {
+			v.push_back(t);
+			return;
+		}
+		vector <Tokid>::iterator i = lower_bound(v.begin(), v.end(), t);
+		if (i == v.end() || *i != t)
+			v.insert(i, t);
+	}
+	// Add the Tokids in t, which can be in any order
+	void merge(vector <Tokid> &t) {
+		sort(t.begin(), t.end());
+		vector <Tokid> r;
+		r.reserve(v.size() + t.size());
+		set_union(v.begin(), v.end(), t.begin(), t.end(), back_inserter(r));
+		v.swap(r);
+	}
+};
 
 class Call;
 
+/*
+ * Equivalence classes are merged as in a union-find structure.
+ * A merged class is linked under the class it was merged into,
+ * and its members keep referring to it until the tree is flattened,
+ * when its members are moved to the tree's root.
+ * Tokid::get_ec() returns the root, so outside this class merged
+ * classes are never seen.
+ */
 class Eclass {
+	friend class Snapshot;
 private:
 	int len;			// Identifier length
 	setTokid members;		// Class members
 	Attributes attr;
+	Eclass *parent;			// Class we were merged into, if any
+	Eclass *child;			// Last class merged into us
+	Eclass *sibling;		// Class merged into our parent before us
+	int merged;			// Number of members in the merged classes
+	static unsigned long count;	// Number of classes
+
+	// Move the members of the merged classes into this class
+	void flatten();
 public:
+	static void *operator new(size_t s) { return Pool::allocate(s); }
+	static void operator delete(void *p, size_t s) { Pool::deallocate(p, s); }
 	// An equivalence class shall know its length
 	inline Eclass(int len);
 	// It can be constructed from an initiall Tokid
 	inline Eclass(Tokid t, int len);
+	~Eclass() { count--; }
 	// Add t to the class; also updates the Tokmap
 	void add_tokid(Tokid t);
 	// Split an equivalence class after the (0-based) character position
@@ -56,12 +113,21 @@ public:
 	// Merge two equivalence classes returning the resulting one
 	// After the merger the values of a and b are undefined
 	friend Eclass *merge(Eclass *a, Eclass *b);
+	// As above, but without adding the classes to the current project
+	friend Eclass *unite(Eclass *a, Eclass *b);
 	// Return length
 	int get_len() const { return len; }
 	// Return number of members
-	int get_size() { return members.size(); }
+	int get_size() { return members.size() + merged; }
 	friend ostream& operator<<(ostream& o,const Eclass& ec);
-	const setTokid & get_members(void) const { return members; }
+	const setTokid & get_members(void) { flatten(); return members; }
+	// Return the class this one has been merged into
+	inline Eclass *find();
+	// Return the number of classes
+	static unsigned long get_count() { return count; }
+	// Flatten all classes; must be called before accessing them
+	// from multiple threads
+	static void flatten_all();
 	// Files where the this appears
 	IFSet sorted_files();
 	// Functions where the this appears
@@ -80,15 +146,48 @@ public:
 
 inline
 Eclass::Eclass(int l)
-: len(l)
+: len(l), parent(NULL), child(NULL), sibling(NULL), merged(0)
 {
+	count++;
 }
 
 inline
 Eclass::Eclass(Tokid t, int l)
-: len(l)
+: len(l), parent(NULL), child(NULL), sibling(NULL), merged(0)
 {
+	count++;
 	add_tokid(t);
 }
 
+inline Eclass *
+Eclass::find()
+{
+	if (parent == NULL)
+		return this;
+	Eclass *root = parent;
+	while (root->parent)
+		root = root->parent;
+	// Compress the path
+	for (Eclass *e = this; e != root; ) {
+		Eclass *next = e->parent;
+		e->parent = root;
+		e = next;
+	}
+	return root;
+}
+
+inline Eclass *
+Tokid::get_ec() const
+{
+	Eclass *ec = fi.get_ec_index().find(offs);
+	return ec ? ec->find() : NULL;
+}
+
+inline Eclass *
+Tokid::check_ec() const
+{
+	Eclass *ec = fi.get_ec_index().find(offs);
+	return ec ? ec->find() : NULL;
+}
+
 #endif /* ECLASS_ */
@@ -0,0 +1,183 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * For documentation read the corresponding .h file
+ *
+ */
+
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+#include <set>
+#include <mutex>
+
+#include "cpp.h"
+#include "debug.h"
+#include "error.h"
+#include "attr.h"
+#include "metrics.h"
+#include "fileid.h"
+#include "fbuffer.h"
+#include "os.h"
+
+vector <Fbuffer *> Fbuffer::cache;	// Indexed by Fileid
+list <int> Fbuffer::lru;		// Cached Fileids, most recent first
+unsigned long Fbuffer::bytes_read;	// Bytes of files loaded
+static mutex cache_lock;		// Serializes access to the above
+
+Fbuffer::Fbuffer(const string &s) :
+	mapped(false),
+	contents(s),
+	users(0),
+	cached(false)
+{
+	data = contents.data();
+	len = contents.length();
+}
+
+Fbuffer::~Fbuffer()
+{
+	if (mapped)
+		unmap_file(data, len);
+}
+
+Fbuffer *
+Fbuffer::load(const string &path)
+{
+	Fbuffer *b = new Fbuffer();
+
+	if ((b->data = map_file(path.c_str(), b->len)) != NULL) {
+		b->mapped = true;
+		return b;
+	}
+	// Not mappable (e.g. a device); read it into memory
+	ifstream in(path.c_str(), ios::binary);
+	if (in.fail()) {
+		delete b;
+		return NULL;
+	}
+	b->contents.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+	b->data = b->contents.data();
+	b->len = b->contents.length();
+	return b;
+}
+
+Fbuffer *
+Fbuffer::acquire(Fileid fi)
+{
+	lock_guard <mutex> guard(cache_lock);
+	vector <Fbuffer *>::size_type id = fi.get_id();
+	if (id >= cache.size())
+		cache.resize(id + 1);
+	Fbuffer *b = cache[id];
+	if (b)
+		lru.splice(lru.begin(), lru, b->lru_pos);
+	else {
+		if ((b = load(fi.get_path())) == NULL)
+			return NULL;
+		bytes_read += b->len;
+		if (DP())
+			cout << "Fbuffer load " << fi.get_path() << " mapped=" << b->mapped << "\n";
+		cache[id] = b;
+		b->cached = true;
+		lru.push_front(id);
+		b->lru_pos = lru.begin();
+	}
+	b->users++;
+	trim();
+	return b;
+}
+
+void
+Fbuffer::release(Fbuffer *b)
+{
+	lock_guard <mutex> guard(cache_lock);
+	csassert(b->users > 0);
+	if (--b->users == 0 && !b->cached)
+		delete b;
+}
+
+void
+Fbuffer::invalidate(Fileid fi)
+{
+	lock_guard <mutex> guard(cache_lock);
+	vector <Fbuffer *>::size_type id = fi.get_id();
+	if (id >= cache.size() || cache[id] == NULL)
+		return;
+	Fbuffer *b = cache[id];
+	cache[id] = NULL;
+	lru.erase(b->lru_pos);
+	b->cached = false;
+	if (b->users == 0)
+		delete b;
+}
+
+void
+Fbuffer::trim()
+{
+	list <int>::iterator i = lru.end();
+	while (lru.size() > max_cached && i != lru.begin()) {
+		Fbuffer *b = cache[*--i];
+		if (b->users)
+			continue;
+		cache[*i] = NULL;
+		i = lru.erase(i);
+		delete b;
+	}
+}
+
+void
+fbstream::open(Fileid fi)
+{
+	close();
+	if ((buf = Fbuffer::acquire(fi)) == NULL)
+		return;
+	data = buf->begin();
+	len = buf->size();
+}
+
+void
+fbstream::open_string(const string &s)
+{
+	close();
+	buf = new Fbuffer(s);
+	owned = true;
+	data = buf->begin();
+	len = buf->size();
+}
+
+void
+fbstream::close()
+{
+	if (buf) {
+		if (owned)
+			delete buf;
+		else
+			Fbuffer::release(buf);
+	}
+	buf = NULL;
+	owned = false;
+	data = NULL;
+	len = pos = 0;
+	at_eof = false;
+}
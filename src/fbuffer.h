@@ -0,0 +1,140 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * The contents of source files, memory-mapped and cached by Fileid.
+ * The lexer and all post-processing passes read files through an
+ * fbstream, which supports the subset of the ifstream interface
+ * that CScout uses.  Positions are plain offsets into the buffer,
+ * so tellg() and seekg() are free, and reopening a file that is
+ * still in the cache costs no system calls.
+ *
+ * Include synopsis:
+ * #include <string>
+ * #include <vector>
+ * #include <list>
+ * #include <ios>
+ *
+ * #include "fileid.h"
+ *
+ */
+
+#ifndef FBUFFER_
+#define FBUFFER_
+
+#include <string>
+#include <vector>
+#include <list>
+#include <ios>			// streampos
+#include <cstdio>		// EOF
+
+using namespace std;
+
+#include "fileid.h"
+
+class Fbuffer {
+private:
+	const char *data;		// File contents
+	size_t len;			// and their length
+	bool mapped;			// True if data is a memory mapping
+	string contents;		// Contents, when they are not mapped
+	int users;			// Number of open fbstreams
+	bool cached;			// True if it is in the cache
+	list <int>::iterator lru_pos;	// Position in the LRU list
+
+	// Maximum number of unused buffers we keep mapped
+	static const size_t max_cached = 1024;
+	static vector <Fbuffer *> cache;	// Indexed by Fileid
+	static list <int> lru;		// Cached Fileids, most recent first
+	static unsigned long bytes_read;	// Bytes of files loaded
+
+	// Map or read the file at path; return NULL on error
+	static Fbuffer *load(const string &path);
+	Fbuffer() : data(NULL), len(0), mapped(false), users(0), cached(false) {}
+	Fbuffer(const Fbuffer &);	// Not copyable
+	Fbuffer &operator=(const Fbuffer &);
+	// Unmap buffers, until the cache is within its size limit
+	static void trim();
+public:
+	// Construct a buffer over the specified contents
+	Fbuffer(const string &s);
+	~Fbuffer();
+	// Return the (possibly cached) contents of the file fi, or NULL
+	// The buffer remains valid until the matching release call
+	// These three methods can be called from multiple threads
+	static Fbuffer *acquire(Fileid fi);
+	static void release(Fbuffer *b);
+	// Remove fi from the cache, e.g. because it is about to change
+	static void invalidate(Fileid fi);
+	// Return the number of bytes loaded from files
+	static unsigned long get_bytes_read() { return bytes_read; }
+	const char *begin() const { return data; }
+	size_t size() const { return len; }
+};
+
+// A stream reading from an Fbuffer
+class fbstream {
+private:
+	Fbuffer *buf;		// Buffer we are reading from
+	bool owned;		// True if we must delete buf on close
+	const char *data;	// Cached buffer contents
+	size_t len;		// and length
+	size_t pos;		// Current position
+	bool at_eof;		// True after reading past the end
+
+	fbstream(const fbstream &);	// Not copyable
+	fbstream &operator=(const fbstream &);
+public:
+	fbstream() : buf(NULL), owned(false), data(NULL), len(0), pos(0), at_eof(false) {}
+	~fbstream() { close(); }
+	// Read from the contents of file fi
+	void open(Fileid fi);
+	// Read from the specified string
+	void open_string(const string &s);
+	void close();
+	bool is_open() const { return buf != NULL; }
+	// Clear the EOF condition
+	void clear() { at_eof = false; }
+	bool fail() const { return buf == NULL || at_eof; }
+	bool eof() const { return at_eof; }
+	// As with ifstream, the position is -1 after reading past the end
+	streampos tellg() const { return at_eof ? (streampos)-1 : (streampos)pos; }
+	inline int get();
+	fbstream &putback(char c) {
+		if (!at_eof && pos > 0)
+			pos--;
+		return *this;
+	}
+	fbstream &seekg(streampos p) {
+		if (!at_eof)
+			pos = (size_t)p;
+		return *this;
+	}
+};
+
+inline int
+fbstream::get()
+{
+	if (at_eof || pos >= len) {
+		at_eof = true;
+		return EOF;
+	}
+	return (unsigned char)data[pos++];
+}
+
+#endif /* FBUFFER_ */
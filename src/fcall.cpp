@@ -59,10 +59,19 @@
 FCall::FCall(const Token& tok, Type typ, const string &s) :
 		Call(s, tok),
 		type(typ),
-		defined(false)
+		defined(false),
+		defined_unit(0),
+		declared_unit(0)
 {
 }
 
+void
+FCall::set_nparam(int n)
+{
+	metrics().set_metric(FunMetrics::em_nparam, n);
+	declared_unit = Pdtoken::get_unit();
+}
+
 /*
  * Set the function currently being parsed
  * This is used for defining yytab, which is not explicitly defined
@@ -79,6 +88,7 @@ FCall::set_current_fun(const Id *id)
 	cfun->metrics().set_metric(FunMetrics::em_ngnsoc,
 	    Block::global_namespace_occupants_size() +
 	    Pdtoken::macros_size());
+	cfun->defined_unit = Pdtoken::get_unit();
 	nesting.push(current_fun);
 }
 
@@ -112,6 +122,7 @@ FCall::set_current_fun(const Type &t)
 	cfun->metrics().set_metric(FunMetrics::em_ngnsoc,
 	    Block::global_namespace_occupants_size() +
 	    Pdtoken::macros_size());
+	cfun->defined_unit = Pdtoken::get_unit();
 	nesting.push(cfun);
 	if (nesting.size() == 1)
 		Fchar::get_fileid().metrics().add_function(t.is_static());
@@ -36,15 +36,21 @@
 
 // C function calling information
 class FCall : public Call {
+	friend class Snapshot;
 private:
 	Tokid definition;		// Function's definition
 	Type type;			// Function's type
 	bool defined;			// True if the function has been defined
+	int defined_unit;		// Unit of the last definition (see Pdtoken::get_unit)
+	int declared_unit;		// Unit of the last declaration
 public:
 	// Set the C function currently being parsed
 	static void set_current_fun(const Type &t);
 	static void set_current_fun(const Id *id);
 
+	// Set the number of parameters of the function's declaration
+	void set_nparam(int n);
+
 	virtual Tokid get_definition() const { return definition; }
 	virtual bool is_defined() const { return defined; }
 	virtual bool is_declared() const { return true; }
@@ -0,0 +1,123 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * For documentation read the corresponding .h file
+ *
+ */
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <deque>
+#include <list>
+#include <stack>
+#include <algorithm>
+#include <climits>
+
+#include "cpp.h"
+#include "debug.h"
+#include "attr.h"
+#include "metrics.h"
+#include "fileid.h"
+#include "tokid.h"
+#include "token.h"
+#include "ptoken.h"
+#include "call.h"
+#include "fcgraph.h"
+
+FileCallGraph::Adjacency FileCallGraph::calls, FileCallGraph::callers;
+
+FileCallGraph::const_iterator
+FileCallGraph::Adjacency::begin(Fileid f) const
+{
+	unsigned id = f.get_id();
+	if (id + 1 >= offset.size())
+		return nodes.end();
+	return nodes.begin() + offset[id];
+}
+
+FileCallGraph::const_iterator
+FileCallGraph::Adjacency::end(Fileid f) const
+{
+	unsigned id = f.get_id();
+	if (id + 1 >= offset.size())
+		return nodes.end();
+	return nodes.begin() + offset[id + 1];
+}
+
+// Order files by their position in the vector the graph is built from
+struct file_position_order {
+	const vector <int> &order;
+	file_position_order(const vector <int> &o) : order(o) {}
+	bool operator()(Fileid a, Fileid b) const {
+		return order[a.get_id()] < order[b.get_id()];
+	}
+};
+
+void
+FileCallGraph::build(Adjacency &a, const vector <Fileid> &files,
+    const vector <int> &order,
+    Call::const_fiterator_type (Call::*abegin)() const,
+    Call::const_fiterator_type (Call::*aend)() const)
+{
+	a.offset.assign(order.size() + 1, 0);
+	a.nodes.clear();
+	// Lay out the neighbors in the order of the file ids
+	vector <Fileid> byid(files);
+	sort(byid.begin(), byid.end());
+	vector <Fileid> neighbors;
+	for (vector <Fileid>::const_iterator f = byid.begin(); f != byid.end(); f++) {
+		/*
+		 * For every C function defined in this file:
+		 * add the files defining the associated C functions.
+		 */
+		neighbors.clear();
+		for (FCallSet::const_iterator filefun = f->get_functions().begin(); filefun != f->get_functions().end(); filefun++) {
+			if (!(*filefun)->is_cfun())
+				continue;
+			for (Call::const_fiterator_type afun = ((*filefun)->*abegin)(); afun != ((*filefun)->*aend)(); afun++)
+				if ((*afun)->is_defined() && (*afun)->is_cfun()) {
+					Fileid f2((*afun)->get_definition().get_fileid());
+					if ((unsigned)f2.get_id() < order.size() && order[f2.get_id()] != INT_MAX)
+						neighbors.push_back(f2);
+				}
+		}
+		sort(neighbors.begin(), neighbors.end(), file_position_order(order));
+		neighbors.erase(unique(neighbors.begin(), neighbors.end()), neighbors.end());
+		a.offset[f->get_id() + 1] = neighbors.size();
+		a.nodes.insert(a.nodes.end(), neighbors.begin(), neighbors.end());
+	}
+	// Convert the neighbor counts into offsets
+	for (vector <int>::size_type i = 1; i < a.offset.size(); i++)
+		a.offset[i] += a.offset[i - 1];
+	if (DP())
+		cout << "File call graph: " << a.nodes.size() << " edges" << endl;
+}
+
+void
+FileCallGraph::build(const vector <Fileid> &files)
+{
+	// The position of each file in files; INT_MAX if it is missing
+	vector <int> order(Fileid::max_id() + 1, INT_MAX);
+	for (vector <Fileid>::size_type i = 0; i < files.size(); i++)
+		order[files[i].get_id()] = i;
+	build(calls, files, order, &Call::call_begin, &Call::call_end);
+	build(callers, files, order, &Call::caller_begin, &Call::caller_end);
+}
@@ -0,0 +1,79 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * The file-level function call graph.
+ * It records, for each file, the files defining the C functions called by
+ * the functions the file defines, and the files defining the C
+ * functions calling them.
+ * The graph is built once, after the files have been analyzed, and is
+ * stored in compressed sparse row form: a file's neighbors are a
+ * contiguous slice of a single array, ordered like the name-sorted
+ * vector of files the graph was built from.
+ * It is used by the web interface, the graphs generated with -R,
+ * and the SQL output.
+ *
+ * Include synopsis:
+ * #include <vector>
+ *
+ * #include "fileid.h"
+ * #include "call.h"
+ *
+ */
+
+#ifndef FCGRAPH_
+#define FCGRAPH_
+
+#include <vector>
+
+using namespace std;
+
+#include "fileid.h"
+#include "call.h"
+
+class FileCallGraph {
+public:
+	typedef vector <Fileid>::const_iterator const_iterator;
+private:
+	// The neighbors of the file with id i are
+	// nodes[offset[i]] to nodes[offset[i + 1]]
+	struct Adjacency {
+		vector <int> offset;
+		vector <Fileid> nodes;
+		const_iterator begin(Fileid f) const;
+		const_iterator end(Fileid f) const;
+	};
+	static Adjacency calls, callers;
+	// Build a, following the relationship obtained through the
+	// abegin and aend methods
+	static void build(Adjacency &a, const vector <Fileid> &files,
+	    const vector <int> &order,
+	    Call::const_fiterator_type (Call::*abegin)() const,
+	    Call::const_fiterator_type (Call::*aend)() const);
+public:
+	// Build the graph for the name-sorted files
+	static void build(const vector <Fileid> &files);
+	// Files defining functions called by functions defined in f
+	static const_iterator calls_begin(Fileid f) { return calls.begin(f); }
+	static const_iterator calls_end(Fileid f) { return calls.end(f); }
+	// Files defining functions calling functions defined in f
+	static const_iterator callers_begin(Fileid f) { return callers.begin(f); }
+	static const_iterator callers_end(Fileid f) { return callers.end(f); }
+};
+
+#endif /* FCGRAPH_ */
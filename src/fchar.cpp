@@ -32,6 +32,11 @@
 #include <list>
 #include <errno.h>
 #include <cstring>
+#if defined(unix) || defined(__unix__) || defined(__MACH__)
+#include <unistd.h>		// access(2)
+#else
+#include <io.h>			// access(2)
+#endif
 
 #include "cpp.h"
 #include "error.h"
@@ -49,7 +54,7 @@
 #include "parse.tab.h"
 #include "fdep.h"
 
-fifstream Fchar::in;
+fbstream Fchar::in;
 Fileid Fchar::fi;
 StackFcharContext Fchar::cs;		// Pushed contexts (from push_input())
 stackFchar Fchar::ps;			// Putback Fchars (from putback())
@@ -58,17 +63,24 @@ bool Fchar::yacc_file;			// True input comes from .y
 stackFchar::size_type Fchar::stack_lock_size;	// Locked elements in file stack
 bool Fchar::trigraphs_enabled;		// True if we handle trigraphs
 bool Fchar::output_headers;		// Debug print of files being processed
+int Fchar::last_val;			// Last character read from a file
 
 void
 Fchar::set_input(const string& s)
 {
-	if (in.is_open())
-		in.close();
-	in.clear();		// Otherwise flags are dirty and open fails
-	in.open(s.c_str(), ios::binary);
+	// Buffers are cached by Fileid, which requires an existing file
+	if (access(s.c_str(), R_OK) != 0)
+		Error::error(E_FATAL, s + ": " + string(strerror(errno)), false);
+	set_input(s, Fileid(s));
+}
+
+void
+Fchar::set_input(const string& s, Fileid f)
+{
+	fi = f;
+	in.open(fi);
 	if (in.fail())
 		Error::error(E_FATAL, s + ": " + string(strerror(errno)), false);
-	fi = Fileid(s);
 	fi.set_gc(false);	// Mark the file for garbage collection
 	if (DP())
 		cout << "set input " << s << " fi: " << fi.get_path() << "\n";
@@ -79,6 +91,14 @@ Fchar::set_input(const string& s)
 
 void
 Fchar::push_input(const string& s, int offset)
+{
+	if (access(s.c_str(), R_OK) != 0)
+		Error::error(E_FATAL, s + ": " + string(strerror(errno)), false);
+	push_input(s, Fileid(s));
+}
+
+void
+Fchar::push_input(const string& s, Fileid f)
 {
 	Fileid includer = fi;
 	int include_lnum = line_number - 1;
@@ -89,7 +109,8 @@ Fchar::push_input(const string& s, int offset)
 			cout << '.';
 		cout << ' ' << s << endl;
 	}
-	set_input(s);
+	set_input(s, f);
+	Pdtoken::file_enter(fi);
 	Fdep::add_include(includer, fi, include_lnum);
 	/*
 	 * First time through:
@@ -178,8 +199,7 @@ Fchar::getnext()
 	for (;;) {
 		simple_getnext();
 
-		static int oval;
-		if (val == EOF && oval != '\n')
+		if (val == EOF && last_val != '\n')
 			/*
 			 * @error
 			 * An included file does not end with a newline
@@ -189,7 +209,7 @@ Fchar::getnext()
 			 */
 			Error::error(E_WARN, "Included file does not end with a newline.");
 		if (val != EOF)
-			oval = val;
+			last_val = val;
 		if (val == EOF) {
 			fi.metrics().done_processing();
 			fi.set_attribute(Project::get_current_projid());
@@ -205,6 +225,7 @@ Fchar::getnext()
 				cout << "getnext returns EOF\n";
 			return;
 		}
+		Pdtoken::file_exit(fi, last_val == '\n');
 		FcharContext fc(cs.top());
 		set_context(fc);
 		cs.pop();
@@ -219,6 +240,41 @@ Fchar::set_context(const FcharContext &fc)
 	line_number = fc.get_line_number();
 }
 
+bool
+Fchar::get_read_state(int &stream, int &back_val, int &back_offset)
+{
+	if (in.eof())
+		return false;
+	stream = (int)in.tellg();
+	if (ps.empty()) {
+		back_val = EOF;
+		back_offset = stream;
+		return true;
+	}
+	const Fchar &b = ps.top();
+	if (ps.size() > 1 || b.val == EOF || b.ti.get_fileid() != fi)
+		return false;
+	back_val = b.val;
+	back_offset = (int)b.ti.get_streampos();
+	return true;
+}
+
+void
+Fchar::set_read_state(int stream, int back_val, int back_offset,
+    int lines, int last)
+{
+	while (!ps.empty())
+		ps.pop();
+	for (int i = 0; i < lines; i++) {
+		fi.process_line(!Pdtoken::skipping());
+		line_number++;
+	}
+	in.seekg(stream);
+	if (back_val != EOF)
+		ps.push(Fchar(back_val, Tokid(fi, back_offset)));
+	last_val = last;
+}
+
 #ifdef UNIT_TEST
 // cl -GX -DWIN32 -c eclass.cpp fileid.cpp tokid.cpp
 // cl -GX -DWIN32 -DUNIT_TEST fchar.cpp tokid.obj eclass.obj fileid.obj kernel32.lib
@@ -33,7 +33,7 @@
 #include "cpp.h"
 #include "tokid.h"
 #include "fchar.h"
-#include "fifstream.h"
+#include "fbuffer.h"
 
 using namespace std;
 
@@ -70,7 +70,7 @@ class Fchar {
 private:
 	void simple_getnext();		// Trigraphs and slicing
 	static bool trigraphs_enabled;	// True if trigraphs are enabled
-	static fifstream in;		// Stream we are reading from
+	static fbstream in;		// Stream we are reading from
 	static Fileid fi;		// and its Fileid
 	static int line_number;		// Current line number
 	static bool yacc_file;		// True if input file is yacc, not C
@@ -80,6 +80,8 @@ private:
 					// from the push_input stack
 
 	static bool output_headers;	// Debug print of files being processed
+	static void set_input(const string& s, Fileid f);
+	static int last_val;		// Last character read from a file
 	int val;
 	Tokid ti;			// (pos_type from tellg(), fi)
 
@@ -90,6 +92,8 @@ public:
 	// Offset is the location of the include file path where the file
 	// was located, and is used for implementing include_next
 	static void push_input(const string& s, int offset = 0);
+	// As above, for a file whose Fileid is already known
+	static void push_input(const string& s, Fileid f);
 	// Next constructor will return c
 	static void putback(Fchar c);
 	/*
@@ -132,6 +136,20 @@ public:
 	static bool is_yacc_file() { return yacc_file; }
 	// Enable the handling of trigraphs
 	static void enable_trigraphs() { trigraphs_enabled = true; }
+	// Return true if the current file was included by another one
+	static bool is_included() { return cs.size() > stack_lock_size; }
+	/*
+	 * Methods for replaying cached lexical analysis results.
+	 * The read state consists of the stream position and the character
+	 * that may have been put back (EOF if none) with its offset.
+	 * get_read_state returns false if the state can not be saved.
+	 * set_read_state moves to a saved state, processing the specified
+	 * number of lines, as if the characters in-between had been read.
+	 */
+	static bool get_read_state(int &stream, int &back_val, int &back_offset);
+	static void set_read_state(int stream, int back_val, int back_offset,
+	    int lines, int last);
+	static int get_last_val() { return last_val; }
 };
 
 #endif /* FCHAR_ */
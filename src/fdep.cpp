@@ -108,34 +108,34 @@ Fdep::dumpSql(Sql *db, Fileid cu)
 	for (FSFMap::const_iterator di = definers.begin(); di != definers.end(); di++) {
 		const set <Fileid> &defs = di->second;
 		for (set <Fileid>::const_iterator i = defs.begin(); i != defs.end(); i++)
-			cout << "INSERT INTO DEFINERS VALUES(" <<
-			Project::get_current_projid() << ',' <<
-			cu.get_id() << ',' <<
-			di->first.get_id() << ',' <<
-			i->get_id() << ");\n";
+			SqlRow(db, cout, "DEFINERS") <<
+			Project::get_current_projid() <<
+			cu.get_id() <<
+			di->first.get_id() <<
+			i->get_id();
 	}
 	for (FSFMap::const_iterator ii = includers.begin(); ii != includers.end(); ii++) {
 		const set <Fileid> &incs = ii->second;
 		for (set <Fileid>::const_iterator i = incs.begin(); i != incs.end(); i++)
-			cout << "INSERT INTO INCLUDERS VALUES(" <<
-			Project::get_current_projid() << ',' <<
-			cu.get_id() << ',' <<
-			ii->first.get_id() << ',' <<
-			i->get_id() << ");\n";
+			SqlRow(db, cout, "INCLUDERS") <<
+			Project::get_current_projid() <<
+			cu.get_id() <<
+			ii->first.get_id() <<
+			i->get_id();
 	}
 	for (set <Fileid>::const_iterator i = providers.begin(); i != providers.end(); i++)
-		cout << "INSERT INTO PROVIDERS VALUES(" <<
-		Project::get_current_projid() << ',' <<
-		cu.get_id() << ',' <<
-		i->get_id() << ");\n";
+		SqlRow(db, cout, "PROVIDERS") <<
+		Project::get_current_projid() <<
+		cu.get_id() <<
+		i->get_id();
 	for (ITMap::const_iterator i = include_triggers.begin(); i != include_triggers.end(); i++)
 		for (include_trigger_value::const_iterator j = i->second.begin(); j != i->second.end(); j++) {
-			cout << "INSERT INTO INCTRIGGERS VALUES(" <<
-			Project::get_current_projid() << ',' <<
-			cu.get_id() << ',' <<
-			i->first.second.get_id() << ',' <<
-			i->first.first.get_id() << ',' <<
-			(unsigned)(j->first) << ',' <<
-			j->second << ");\n";
+			SqlRow(db, cout, "INCTRIGGERS") <<
+			Project::get_current_projid() <<
+			cu.get_id() <<
+			i->first.second.get_id() <<
+			i->first.first.get_id() <<
+			(unsigned)(j->first) <<
+			j->second;
 		}
 }
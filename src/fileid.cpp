@@ -47,10 +47,14 @@
 #include "fileid.h"
 #include "tokid.h"
 #include "fchar.h"
+#include "fbuffer.h"
 #include "token.h"
 #include "parse.tab.h"
 #include "ptoken.h"
 #include "pltoken.h"
+#include "macro.h"
+#include "compiledre.h"
+#include "pdtoken.h"
 #include "call.h"
 #include "md5.h"
 #include "os.h"
@@ -185,20 +189,31 @@ Fileid::set_readonly(bool r)
 	i2d[id].set_readonly(r);
 }
 
+/*
+ * Set the required property, recording the compilation unit
+ * that set it, so that merged shards can keep the last value.
+ */
+void
+Fileid::set_required(bool v)
+{
+	i2d[id].set_required(v, Pdtoken::get_unit());
+}
+
 Filedetails::Filedetails(string n, bool r, const FileHash &h) :
 	name(n),
 	m_garbage_collected(false),
 	m_required(false),
+	required_unit(0),
 	m_compilation_unit(false),
 	hash(h),
 	ipath_offset(0),
-	hand_edited(false),
-	visited(false)
+	hand_edited(false)
 {
 	set_readonly(r);
 }
 
 Filedetails::Filedetails() :
+	required_unit(0),
 	m_compilation_unit(false),
 	ipath_offset(0),
 	hand_edited(false)
@@ -271,8 +286,7 @@ Fileid::files(bool sorted)
 void
 Fileid::clear_all_visited()
 {
-	for (FI_id_to_details::iterator i = i2d.begin(); i != i2d.end(); i++)
-		i->clear_visited();
+	VisitMark <file_visit_tag>::clear_all();
 }
 
 void
@@ -317,6 +331,14 @@ Filedetails::hand_edit()
 	return 0;
 }
 
+int
+Fileid::hand_edit()
+{
+	// The file is about to change under its cached buffer
+	Fbuffer::invalidate(*this);
+	return i2d[id].hand_edit();
+}
+
 // Read identifier tokens from file fname into tkov
 static void
 read_file(const string &fname, vector <Pltoken> &tokv)
@@ -345,7 +367,6 @@ unify_file_identifiers(const set<Fileid> &fs)
 {
 	csassert(fs.size() > 1);
 	Fileid fi = *(fs.begin());
-	fifstream in;
 	vector <Pltoken> ft0, ftn;	// The tokens to unify
 
 	read_file(fi.get_path(), ft0);
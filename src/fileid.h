@@ -30,6 +30,8 @@
  *
  * #include "attr.h"
  * #include "metrics.h"
+ * #include "ecindex.h"
+ * #include "visitmark.h"
  *
  */
 
@@ -42,6 +44,8 @@
 using namespace std;
 
 #include "filemetrics.h"
+#include "ecindex.h"
+#include "visitmark.h"
 
 using namespace std;
 
@@ -73,6 +77,7 @@ public:
 class Fileid;
 class Fchar;
 class Call;
+struct file_visit_tag;
 
 // Used to order Call sets by their function location in a file
 struct function_file_order : public binary_function <const Call *, const Call *, bool> {
@@ -86,10 +91,12 @@ typedef set <Fileid> Fileidset;
 
 // Details we keep for each file
 class Filedetails {
+	friend class Snapshot;
 private:
 	string name;	// File name (complete path)
 	bool m_garbage_collected;	// When postprocessing files to garbage collect ECs
 	bool m_required;		// When postprocessing files actually required (containing definitions)
+	int required_unit;		// Unit that last set m_required (see Pdtoken::get_unit)
 	bool m_compilation_unit;	// This file is a compilation unit (set by gc)
 	// Line end offsets; collected during postprocessing
 	// when we are generating warning reports
@@ -108,7 +115,8 @@ private:
 
 	bool hand_edited;	// True for files that have been hand-edited
 	string contents;	// Original contents, if hand-edited
-	bool visited;                   // For calculating transitive closures
+	VisitMark <file_visit_tag> visited;	// For calculating transitive closures
+	EcIndex ecs;			// Equivalence classes of the file's tokids
 public:
 	Attributes attr;		// The projects this file participates in
 	FileMetrics m;			// File's metrics
@@ -122,7 +130,7 @@ public:
 	bool garbage_collected() const { return m_garbage_collected; }
 	void set_gc(bool r) { m_garbage_collected = r; }
 	bool required() const { return m_required; }
-	void set_required(bool r) { m_required = r; }
+	void set_required(bool r, int unit) { m_required = r; required_unit = unit; }
 	bool compilation_unit() const { return m_compilation_unit; }
 	void set_compilation_unit(bool r) { m_compilation_unit = r; }
 	void process_line(bool processed);
@@ -151,9 +159,9 @@ public:
 	// Include file path offset
 	int get_ipath_offset() const { return ipath_offset; }
 	void set_ipath_offset(int o) { ipath_offset = o; }
-	void set_visited() { visited = true; }
-	void clear_visited() { visited = false; }
-	bool is_visited() const { return visited; }
+	void set_visited() { visited.set(); }
+	void clear_visited() { visited.clear(); }
+	bool is_visited() const { return (bool)visited.get(); }
 	// Add file that this file uses at runtime
 	void glob_uses(Fileid f);
 	// Add file that is used by this file at runtime
@@ -162,6 +170,8 @@ public:
 	const Fileidset & glob_uses() const { return runtime_uses; }
 	// Return the set of files that depend on us for runtime objects
 	const Fileidset & glob_used_by() const { return runtime_used_by; }
+	// Return the index of the file's tokid equivalence classes
+	EcIndex &get_ec_index() { return ecs; }
 };
 
 typedef map <string, int> FI_uname_to_id;
@@ -181,6 +191,7 @@ typedef map <FileHash, set<Fileid> > FI_hash_to_ids;
  * Add details in the Filedetails class
  */
 class Fileid {
+	friend class Snapshot;
 private:
 	int id;				// One global unique id per workspace file
 
@@ -238,7 +249,7 @@ public:
 	void set_gc(bool v) { i2d[id].set_gc(v); }
 	bool garbage_collected() const { return i2d[id].garbage_collected(); }
 	// Get/set required property (for include files)
-	void set_required(bool v) { i2d[id].set_required(v); }
+	void set_required(bool v);
 	bool required() const { return i2d[id].required(); }
 	// Get/set compilation_unit property (for include files)
 	void set_compilation_unit(bool v) { i2d[id].set_compilation_unit(v); }
@@ -266,6 +277,9 @@ public:
 	// Add file that is used by this file at runtime
 	void glob_used_by(Fileid f) { i2d[id].glob_used_by(f); }
 
+	// Return the index of the file's tokid equivalence classes
+	EcIndex &get_ec_index() const { return i2d[id].get_ec_index(); }
+
 	// Add and retrieve line numbers
 	// Should be called every time a newline is encountered
 	void add_line_end(streampos p) { i2d[id].add_line_end(p); }
@@ -289,7 +303,7 @@ public:
 	inline friend bool operator !=(const class Fileid a, const class Fileid b);
 	inline friend bool operator <(const class Fileid a, const class Fileid b);
 	// Should be called before hand-editing.  Return 0 if OK, !0 on error.
-	int hand_edit() { return i2d[id].hand_edit(); }
+	int hand_edit();
 	// True if file has been hand-edited
 	bool is_hand_edited() { return i2d[id].is_hand_edited(); }
 	// Return the file's original contents
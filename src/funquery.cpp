@@ -218,6 +218,15 @@ FunQuery::param_url() const
 	return r;
 }
 
+bool
+FunQuery::get_name_re(string &re) const
+{
+	if (lazy || call || id_ec || !match_fnre || exclude_fnre)
+		return false;
+	re = str_fnre;
+	return true;
+}
+
 // Evaluate the object's identifier query against i
 // return true if it matches
 bool
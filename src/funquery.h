@@ -90,6 +90,9 @@ public:
 
 	// Perform a query
 	bool eval(Call *c);
+	// Set re to an RE the names of all matching functions match
+	// Return false if there is no such RE
+	bool get_name_re(string &re) const;
 	// Return the URL for re-executing this query
 	string base_url() const;
 	// Return the query's parameters as a URL
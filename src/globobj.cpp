@@ -143,7 +143,7 @@ GlobObj::dumpSql(Sql *db, ostream &of)
 		}
 
 		int start = 0, ord = 0;
-		for (dequeTpart::const_iterator j = fun->get_token().get_parts_begin(); j != fun->get_token().get_parts_end(); j++) {
+		for (vectorTpart::const_iterator j = fun->get_token().get_parts_begin(); j != fun->get_token().get_parts_end(); j++) {
 			Tokid t2 = j->get_tokid();
 			int len = j->get_len() - start;
 			int pos = 0;
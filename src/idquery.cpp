@@ -225,6 +225,15 @@ IdQuery::param_url() const
 	return r;
 }
 
+bool
+IdQuery::get_name_re(string &re) const
+{
+	if (lazy || ec || !match_ire || exclude_ire)
+		return false;
+	re = str_ire;
+	return true;
+}
+
 // Evaluate the object's identifier query against i
 // return true if it matches
 bool
@@ -237,9 +246,6 @@ IdQuery::eval(const IdPropElem &i)
 		return (i.first == ec);
 	if (current_project && !i.first->get_attribute(current_project))
 		return false;
-	int retval = exclude_ire ? 0 : REG_NOMATCH;
-	if (match_ire && ire.exec(i.second.get_id()) == retval)
-		return false;
 	bool add = false;
 	switch (match_type) {
 	case 'Y':	// anY match
@@ -289,6 +295,15 @@ IdQuery::eval(const IdPropElem &i)
 	}
 	if (!add)
 		return false;
+	return eval_re(i);
+}
+
+bool
+IdQuery::eval_re(const IdPropElem &i)
+{
+	int retval = exclude_ire ? 0 : REG_NOMATCH;
+	if (match_ire && ire.exec(i.second.get_id()) == retval)
+		return false;
 	if (match_fre) {
 		// Before we add it check if its filename matches the RE
 		IFSet f = i.first->sorted_files();
@@ -309,3 +324,94 @@ IdQuery::eval(const IdPropElem &i)
 	}
 	return true;
 }
+
+bool
+IdQuery::eval_attributes(const IdAttributes &a, Bitmap &b) const
+{
+	if (lazy || ec)
+		return false;
+	size_t n = a.size();
+	switch (match_type) {
+	case 'Y':	// anY match
+		b = Bitmap(n);
+		for (int j = attr_begin; j < attr_end; j++)
+			if (match[j])
+				b |= a.get_attribute(j);
+		if (xfile)
+			b |= a.get_xfile();
+		if (unused)
+			b |= a.get_unused();
+		if (writable)
+			b |= Bitmap(a.get_attribute(is_readonly)).flip();
+		break;
+	case 'L':	// alL match
+		b = Bitmap(n, true);
+		for (int j = attr_begin; j < attr_end; j++)
+			if (match[j])
+				b &= a.get_attribute(j);
+		if (xfile)
+			b &= a.get_xfile();
+		if (unused)
+			b &= a.get_unused();
+		if (writable)
+			b.and_not(a.get_attribute(is_readonly));
+		break;
+	case 'E':	// excludE match
+		b = Bitmap(n, true);
+		for (int j = attr_begin; j < attr_end; j++)
+			if (match[j])
+				b.and_not(a.get_attribute(j));
+		if (xfile)
+			b.and_not(a.get_xfile());
+		if (unused)
+			b.and_not(a.get_unused());
+		if (writable)
+			b &= a.get_attribute(is_readonly);
+		break;
+	case 'T':	// exactT match
+		b = Bitmap(n, true);
+		for (int j = attr_begin; j < attr_end; j++)
+			if (match[j])
+				b &= a.get_attribute(j);
+			else
+				b.and_not(a.get_attribute(j));
+		if (xfile)
+			b &= a.get_xfile();
+		else
+			b.and_not(a.get_xfile());
+		if (unused)
+			b &= a.get_unused();
+		else
+			b.and_not(a.get_unused());
+		if (writable)
+			b.and_not(a.get_attribute(is_readonly));
+		else
+			b &= a.get_attribute(is_readonly);
+		break;
+	default:
+		b = Bitmap(n);
+		break;
+	}
+	if (current_project)
+		b &= a.get_attribute(current_project);
+	return true;
+}
+
+void
+IdAttributes::build(const vector <IdProp::iterator> &ids)
+{
+	size_t n = ids.size();
+	attr.assign(Attributes::get_num_attributes(), Bitmap(n));
+	xfile = Bitmap(n);
+	unused = Bitmap(n);
+	for (size_t i = 0; i < n; i++) {
+		Eclass *ec = ids[i]->first;
+		for (Attributes::size_type j = 0; j < attr.size(); j++)
+			if (ec->get_attribute(j))
+				attr[j].set(i);
+		if (ids[i]->second.get_xfile())
+			xfile.set(i);
+		if (ec->is_unused())
+			unused.set(i);
+	}
+}
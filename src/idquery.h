@@ -26,11 +26,13 @@
 #define IDQUERY_
 
 #include <string>
+#include <vector>
 
 using namespace std;
 
 #include "query.h"
 #include "eclass.h"
+#include "bitmap.h"
 
 class Identifier;
 
@@ -47,16 +49,11 @@ public:
 	// Additional identifier properties required for refactoring
 	static IdProp ids;
 
-	Identifier(Eclass *e, const string &s) : id(s), replaced(false), active(true) {
-		/*
-		 * Normally, e crosses a file boundary if the EFn, the # of files it appears in > 1
-		 * If we take into account the possibility of identical files EFi we must also
-		 * ensure that EFn != EFi
-		 * For this second condition it is enough to check the identical files of one element
-		 */
-		Tokid amember(*(e->get_members().begin()));
-		xfile = e->sorted_files().size() > amember.get_fileid().get_identical_files().size();
-	}
+	/*
+	 * xfile is established through set_xfile() once all files
+	 * have been analyzed, when the EC's members are known.
+	 */
+	Identifier(Eclass *e, const string &s) : id(s), xfile(false), replaced(false), active(true) {}
 	Identifier() : xfile(false), replaced(false), active(false) {}
 	string get_id() const { return id; }
 	void set_newid(const string &s) { newid = s; replaced = true; }
@@ -77,6 +74,26 @@ public:
 
 typedef IdProp::value_type IdPropElem;
 
+/*
+ * The attributes of a sequence of identifiers, stored as one bitmap
+ * per attribute, indexed by the identifiers' position.
+ * They allow the attribute part of identifier queries to be evaluated
+ * for all identifiers a word at a time.
+ */
+class IdAttributes {
+private:
+	vector <Bitmap> attr;	// Identifiers with each attribute and project
+	Bitmap xfile;		// Identifiers crossing files
+	Bitmap unused;		// Unused identifiers
+public:
+	// Record the attributes of the identifiers in ids
+	void build(const vector <IdProp::iterator> &ids);
+	size_t size() const { return xfile.size(); }
+	const Bitmap &get_attribute(int v) const { return attr[v]; }
+	const Bitmap &get_xfile() const { return xfile; }
+	const Bitmap &get_unused() const { return unused; }
+};
+
 class IdQuery : public Query {
 private:
 	char match_type;	// Type of boolean match
@@ -110,6 +127,17 @@ public:
 
 	// Perform a query
 	bool eval(const IdPropElem &i);
+	/*
+	 * Set b to the identifiers recorded in a that satisfy the query's
+	 * project and attribute criteria.
+	 * Return false if the query can not be evaluated in this way.
+	 */
+	bool eval_attributes(const IdAttributes &a, Bitmap &b) const;
+	// Evaluate the query's regular expressions against i
+	bool eval_re(const IdPropElem &i);
+	// Set re to an RE the names of all matching identifiers match
+	// Return false if there is no such RE
+	bool get_name_re(string &re) const;
 	// Return the URL for re-executing this query
 	string base_url() const;
 	// Return the query's parameters as a URL
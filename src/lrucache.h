@@ -0,0 +1,78 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * A map holding a bounded number of entries.  When it is full, adding
+ * an entry evicts the one that was least recently added or looked up.
+ *
+ * Include synopsis:
+ * #include <cstddef>
+ * #include <list>
+ * #include <map>
+ *
+ */
+
+#ifndef LRUCACHE_
+#define LRUCACHE_
+
+#include <cstddef>
+#include <list>
+#include <map>
+
+using namespace std;
+
+template <class K, class V>
+class LruCache {
+private:
+	typedef list <pair <K, V> > list_type;
+	list_type entries;		// Most recently used first
+	map <K, typename list_type::iterator> index;
+	size_t capacity;		// Maximum number of entries
+public:
+	LruCache(size_t c) : capacity(c) {}
+	// Return the value stored for k, or NULL if there is none
+	V *get(const K &k) {
+		typename map <K, typename list_type::iterator>::iterator i = index.find(k);
+		if (i == index.end())
+			return NULL;
+		entries.splice(entries.begin(), entries, i->second);
+		return &i->second->second;
+	}
+	// Store an empty value for k and return it for filling in
+	V &put(const K &k) {
+		typename map <K, typename list_type::iterator>::iterator i = index.find(k);
+		if (i != index.end()) {
+			entries.erase(i->second);
+			index.erase(i);
+		}
+		entries.push_front(make_pair(k, V()));
+		index[k] = entries.begin();
+		if (entries.size() > capacity) {
+			index.erase(entries.back().first);
+			entries.pop_back();
+		}
+		return entries.front().second;
+	}
+	// Remove all entries
+	void clear() {
+		entries.clear();
+		index.clear();
+	}
+};
+
+#endif /* LRUCACHE_ */
@@ -339,7 +339,7 @@ void
 Macro::register_macro_body(mapMacroBody &map) const
 {
 	for (dequePtoken::const_iterator i = value.begin(); i != value.end(); i++)
-		for (dequeTpart::const_iterator j = i->get_parts_begin(); j != i->get_parts_end(); j++)
+		for (vectorTpart::const_iterator j = i->get_parts_begin(); j != i->get_parts_end(); j++)
 			map[j->get_tokid()] = this->mcall;
 }
 
@@ -362,9 +362,9 @@ Macro::Macro( const Ptoken& name, bool id, bool isfun, bool isimmutable) :
 		mcall = NULL;	// To void nasty surprises
 }
 
-static PtokenSequence subst(const Macro &m, dequePtoken is, const mapArgval &args, HideSet hs, bool skip_defined, const Macro *caller);
-static PtokenSequence inline hsadd(const HideSet& hs, const PtokenSequence& ts);
-static PtokenSequence glue(PtokenSequence ls, PtokenSequence rs);
+static PtokenSequence subst(const Macro &m, dequePtoken is, const mapArgval &args, const HideSet &hs, bool skip_defined, const Macro *caller);
+static void inline hsadd(const HideSet& hs, PtokenSequence& ts);
+static void glue(PtokenSequence &ls, PtokenSequence rs);
 static bool fill_in(PtokenSequence &ts, bool get_more, PtokenSequence &removed);
 
 /*
@@ -478,7 +478,7 @@ find_nonspace(dequePtoken::iterator pos, dequePtoken::iterator end)
  * hide set added to it, before getting returned.
  */
 static PtokenSequence
-subst(const Macro &m, dequePtoken is, const mapArgval &args, HideSet hs, bool skip_defined, const Macro *caller)
+subst(const Macro &m, dequePtoken is, const mapArgval &args, const HideSet &hs, bool skip_defined, const Macro *caller)
 {
 	PtokenSequence os;	// output sequence
 
@@ -504,11 +504,11 @@ subst(const Macro &m, dequePtoken is, const mapArgval &args, HideSet hs, bool sk
 				if ((ai = find_formal_argument(args, *ti)) != args.end()) {
 					is.erase(is.begin(), ++ti);
 					if (ai->second.size() != 0)	// Only if actuals can be empty
-						os = glue(os, ai->second);
+						glue(os, ai->second);
 				} else {
 					PtokenSequence t(ti, ti + 1);
 					is.erase(is.begin(), ++ti);
-					os = glue(os, t);
+					glue(os, t);
 				}
 				continue;
 			}
@@ -561,35 +561,34 @@ subst(const Macro &m, dequePtoken is, const mapArgval &args, HideSet hs, bool sk
 		}
 		os.push_back(head);
 	}
-	return (hsadd(hs, os));
+	hsadd(hs, os);
+	return (os);
 }
 
-// Return a new token sequence with hs added to the hide set of every element of ts
-static inline PtokenSequence
-hsadd(const HideSet& hs, const PtokenSequence& ts)
+// Add hs to the hide set of every element of ts
+static inline void
+hsadd(const HideSet& hs, PtokenSequence& ts)
 {
-	PtokenSequence r;
-	for (PtokenSequence::const_iterator i = ts.begin(); i != ts.end(); i++) {
-		Ptoken t(*i);
-		t.hideset_insert(hs.begin(), hs.end());
-		r.push_back(t);
-	}
-	if (DP()) cout << "hsadd returns: " << r << endl;
-	return (r);
+	const HideSet *ihs = HideSets::intern(hs);
+	for (PtokenSequence::iterator i = ts.begin(); i != ts.end(); i++)
+		i->hideset_insert(ihs);
+	if (DP()) cout << "hsadd returns: " << ts << endl;
 }
 
-// Paste last of left side with first of right side
-static PtokenSequence
-glue(PtokenSequence ls, PtokenSequence rs)
+// Paste last of left side with first of right side, leaving the result in ls
+static void
+glue(PtokenSequence &ls, PtokenSequence rs)
 {
-	if (ls.empty())
-		return (rs);
+	if (ls.empty()) {
+		ls.swap(rs);
+		return;
+	}
 	while (!ls.empty() && ls.back().is_space())
 		ls.pop_back();
 	while (!rs.empty() && rs.front().is_space())
 		rs.pop_front();
 	if (ls.empty() && rs.empty())
-		return (ls);
+		return;
 	Tchar::clear();
 	if (!ls.empty()) {
 		if (DP()) cout << "glue LS: " << ls.back() << endl;
@@ -612,7 +611,6 @@ glue(PtokenSequence ls, PtokenSequence rs)
 	}
 	ls.splice(ls.end(), rs);
 	if (DP()) cout << "glue returns: " << ls << endl;
-	return (ls);
 }
 
 /*
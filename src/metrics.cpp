@@ -19,6 +19,7 @@
 #include <vector>
 #include <sstream>		// ostringstream
 #include <list>
+#include <functional>	// plus
 #include <cmath>		// log
 #include <errno.h>
 
@@ -159,6 +160,16 @@ IdCount::add(Eclass *ec, UnaryFunction f)
 			count[i] = f(count[i]);
 }
 
+// Combine the counts of o into ours using function object f
+template <class BinaryFunction>
+void
+IdCount::merge(const IdCount &o, BinaryFunction f)
+{
+	total = f(total, o.total);
+	for (int i = attr_begin; i < attr_end; i++)
+		count[i] = f(count[i], o.count[i]);
+}
+
 // Called for each identifier occurence (all)
 void
 IdMetricsSummary::add_id(Eclass *ec)
@@ -176,6 +187,19 @@ IdMetricsSummary::add_unique_id(Eclass *ec)
 	rw[ec->get_attribute(is_readonly)].minlen.add(ec, set_min(ec->get_len()));
 }
 
+IdMetricsSummary &
+IdMetricsSummary::operator+=(const IdMetricsSummary &o)
+{
+	for (int i = 0; i < 2; i++) {
+		rw[i].once.merge(o.rw[i].once, plus<double>());
+		rw[i].len.merge(o.rw[i].len, plus<double>());
+		rw[i].maxlen.merge(o.rw[i].maxlen, get_max());
+		rw[i].minlen.merge(o.rw[i].minlen, get_min_set());
+		rw[i].all.merge(o.rw[i].all, plus<double>());
+	}
+	return *this;
+}
+
 ostream&
 operator<<(ostream& o, const IdMetricsSet &mi)
 {
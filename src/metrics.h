@@ -70,6 +70,7 @@ struct MetricDetails {
 
 // Metrics for regions of code (files and functions)
 class Metrics {
+	friend class Snapshot;
 private:
 	int currlinelen;
 	enum e_cfile_state cstate;
@@ -157,6 +158,7 @@ class IdMetricsSet;
 
 // A class for keeping taly of various identifier type counts
 class IdCount {
+	friend class Snapshot;
 private:
 	double total;
 	vector <double> count;		// Counts per identifier attribute
@@ -170,6 +172,9 @@ public:
 	// using function object f
 	template <class UnaryFunction>
 	void add(Eclass *ec, UnaryFunction f);
+	// Combine the counts of o into ours using function object f
+	template <class BinaryFunction>
+	void merge(const IdCount &o, BinaryFunction f);
 	friend ostream& operator<<(ostream& o, const IdMetricsSet &m);
 };
 
@@ -180,6 +185,7 @@ class IdMetricsSet;
 // One such set is kept for readable and writable identifiers
 class IdMetricsSet {
 	friend class IdMetricsSummary;
+	friend class Snapshot;
 	IdCount once;	// Each identifier EC is counted once
 	IdCount len;	// Use the len of each EC
 	IdCount maxlen;	// Maximum length for each type
@@ -191,12 +197,15 @@ public:
 
 // This can be kept per project and globally
 class IdMetricsSummary {
+	friend class Snapshot;
 	IdMetricsSet rw[2];			// For writable (0) and read-only (1) cases
 public:
 	// Called for every identifier occurence
 	void add_id(Eclass *ec);
 	// Called for every unique identifier occurence (EC)
 	void add_unique_id(Eclass *ec);
+	// Add the counts of o, e.g. a summary kept by another thread
+	IdMetricsSummary &operator+=(const IdMetricsSummary &o);
 	friend ostream& operator<<(ostream& o,const IdMetricsSummary &ms);
 };
 
@@ -239,6 +248,12 @@ struct get_min : public binary_function<double, double, double>
       double operator()(double x, double y) { return (x > y) ? y : x; }
 };
 
+// Minimum of two set_min results; zero means no value
+struct get_min_set : public binary_function<double, double, double>
+{
+      double operator()(double x, double y) { return (x > 0 && (x < y || y == 0)) ? x : y; }
+};
+
 // Return the average of a sum v over n values as a string
 string avg(double v, double n);
 
@@ -213,10 +213,10 @@ file_obfuscate(Fileid fid)
 {
 	string plain;
 	Tokid plainstart;
-	fifstream in;
+	fbstream in;
 	ofstream out;
 
-	in.open(fid.get_path().c_str(), ios::binary);
+	in.open(fid);
 	if (in.fail()) {
 		perror(fid.get_path().c_str());
 		exit(1);
@@ -86,11 +86,61 @@ is_absolute_filename(const string &s)
 	return (s.length() > 0 && (s[0] == '/' || s[0] == '\\')) ||
 	    (s.length() > 3 && s[1] == ':' && (s[2] == '/' || s[2] == '\\'));
 }
+/*
+ * Map the file's contents read-only.
+ * Return NULL on error; the caller can then fall back to reading it.
+ */
+const char *
+map_file(const char *name, size_t &len)
+{
+	HANDLE f = CreateFile(name, GENERIC_READ, FILE_SHARE_READ, NULL,
+	    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (f == INVALID_HANDLE_VALUE)
+		return NULL;
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(f, &size) || size.HighPart != 0) {
+		CloseHandle(f);
+		return NULL;
+	}
+	len = size.LowPart;
+	if (len == 0) {
+		// Empty files can't be mapped
+		CloseHandle(f);
+		return "";
+	}
+	HANDLE m = CreateFileMapping(f, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(f);
+	if (m == NULL)
+		return NULL;
+	const char *p = (const char *)MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(m);		// The view keeps the mapping alive
+	return p;
+}
+
+void
+unmap_file(const char *data, size_t len)
+{
+	if (len)
+		UnmapViewOfFile(data);
+}
+
+/*
+ * File names are matched without regard to case, so a listing can't
+ * tell whether a name exists.
+ */
+bool
+read_dir(const char *name, set<string> &entries)
+{
+	return false;
+}
 #endif /* WIN32 */
 
 #if defined(unix) || defined(__unix__) || defined(__MACH__)
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <dirent.h>
+#include <fcntl.h>
 #include <stdio.h>
 #include <unistd.h>
 #include <limits.h>
@@ -137,5 +187,57 @@ is_absolute_filename(const string &s)
 {
 	return s.length() > 0 && s[0] == '/';
 }
+/*
+ * Map the file's contents read-only.
+ * Return NULL on error; the caller can then fall back to reading it.
+ */
+const char *
+map_file(const char *name, size_t &len)
+{
+	int fd = open(name, O_RDONLY);
+	if (fd == -1)
+		return NULL;
+	struct stat sb;
+	if (fstat(fd, &sb) != 0 || !S_ISREG(sb.st_mode)) {
+		close(fd);
+		return NULL;
+	}
+	len = (size_t)sb.st_size;
+	if (len == 0) {
+		// Empty files can't be mapped
+		close(fd);
+		return "";
+	}
+	void *p = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);		// The mapping keeps the file open
+	if (p == MAP_FAILED)
+		return NULL;
+	return (const char *)p;
+}
+
+void
+unmap_file(const char *data, size_t len)
+{
+	if (len)
+		(void)munmap((void *)data, len);
+}
+
+bool
+read_dir(const char *name, set<string> &entries)
+{
+#ifdef __MACH__
+	// The default file system is case-insensitive
+	return false;
+#else
+	DIR *d = opendir(name);
+	if (d == NULL)
+		return false;
+	struct dirent *e;
+	while ((e = readdir(d)) != NULL)
+		entries.insert(e->d_name);
+	closedir(d);
+	return true;
+#endif /* __MACH__ */
+}
 #endif /* unix */
 
@@ -24,6 +24,7 @@
 #ifndef OS_
 #define OS_
 
+#include <set>
 #include <string>
 
 using namespace std;
@@ -34,5 +35,12 @@ const char *get_uniq_fname_string(const char *pathname);
 const char *get_full_path(const char *pathname);
 // Return true if pathname is an absolute file path
 bool is_absolute_filename(const string &pathname);
+// Map the file's contents read-only; set len and return NULL on error
+const char *map_file(const char *pathname, size_t &len);
+// Unmap contents returned by map_file
+void unmap_file(const char *data, size_t len);
+// Add the names of the entries in a directory to entries
+// Return false if the directory can't be listed reliably
+bool read_dir(const char *pathname, set<string> &entries);
 
 #endif // OS_
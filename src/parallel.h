@@ -0,0 +1,81 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Distribution of independent work items over a set of threads.
+ * Used for the passes that run after parsing, when the workspace
+ * is only read.  The work function must not modify shared state;
+ * the caller merges any per-item or per-thread results afterwards.
+ *
+ * Include synopsis:
+ * #include <algorithm>
+ * #include <vector>
+ * #include <thread>
+ * #include <atomic>
+ *
+ */
+
+#ifndef PARALLEL_
+#define PARALLEL_
+
+#include <algorithm>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+using namespace std;
+
+class Parallel {
+private:
+	static unsigned nthreads;	// Number of threads to use
+public:
+	// Set the number of threads to use; 0 means one per CPU
+	static void set_threads(unsigned n);
+	static unsigned get_threads() { return nthreads; }
+	/*
+	 * Call f(i, t) for every i in [0, n), using up to get_threads()
+	 * threads.  Items are handed out in increasing order.
+	 * t is the index of the thread processing i; it can be used
+	 * to select a per-thread accumulator.
+	 */
+	template <typename F> static void for_each(size_t n, F f);
+};
+
+template <typename F>
+void
+Parallel::for_each(size_t n, F f)
+{
+	unsigned nt = (unsigned)min((size_t)nthreads, n);
+
+	if (nt <= 1) {
+		for (size_t i = 0; i < n; i++)
+			f(i, 0);
+		return;
+	}
+	atomic <size_t> next(0);
+	vector <thread> workers;
+	for (unsigned t = 0; t < nt; t++)
+		workers.push_back(thread([&f, &next, n, t]() {
+			for (size_t i; (i = next++) < n; )
+				f(i, t);
+		}));
+	for (vector <thread>::iterator i = workers.begin(); i != workers.end(); i++)
+		i->join();
+}
+
+#endif /* PARALLEL_ */
@@ -50,6 +50,7 @@
 #include "parse.tab.h"
 #include "ptoken.h"
 #include "fchar.h"
+#include "fdep.h"
 #include "pltoken.h"
 #include "macro.h"
 #include "pdtoken.h"
@@ -62,6 +63,7 @@
 #include "mcall.h"
 #include "os.h"
 #include "ctag.h"
+#include "profile.h"
 #include "type.h"		// stab.h
 #include "stab.h"		// Block::enter()
 
@@ -75,9 +77,16 @@ int Pdtoken::skiplevel = 0;		// Level of enclosing #ifs when skipping
 mapMacroBody Pdtoken::macro_body_tokens;	// Tokens and the macros they belong to
 // Files that must be skipped rather than included (#pragma once)
 set<Fileid> Pdtoken::skipped_includes;
+vector <Pdtoken::GuardScan> Pdtoken::guard_scans;	// For the files being read
+map <Fileid, Pdtoken::IncludeGuard> Pdtoken::include_guards;	// Files' guards
 vectorPdtoken Pdtoken::current_line;	// Currently read line
 
 CompiledRE Pdtoken::preprocessed_output_spec;	// Files to preprocess
+int Pdtoken::shard, Pdtoken::nshards;		// Projects we process
+int Pdtoken::nprojects;				// Projects encountered so far
+int Pdtoken::nunits;				// Compilation units encountered so far
+bool Pdtoken::shard_skip;			// True when skipping a project's files
+unsigned long Pdtoken::includes_resolved;	// Include directives resolved
 
 bool
 Pdtoken::shall_skip(Fileid fid)
@@ -88,6 +97,97 @@ Pdtoken::shall_skip(Fileid fid)
 	return ret;
 }
 
+void
+Pdtoken::guard_directive(const string &name)
+{
+	if (guard_scans.empty())
+		return;
+	GuardScan &g = guard_scans.back();
+	switch (g.state) {
+	case gs_start:
+		if (name == "ifndef") {
+			// process_ifdef sets the macro
+			g.state = gs_guarded;
+			g.depth = 1;
+		} else
+			g.state = gs_none;
+		break;
+	case gs_guarded:
+		if (name == "if" || name == "ifdef" || name == "ifndef")
+			g.depth++;
+		else if (name == "endif") {
+			if (--g.depth == 0)
+				g.state = gs_end;
+		} else if ((name == "else" || name == "elif") && g.depth == 1)
+			g.state = gs_none;
+		break;
+	case gs_end:
+		g.state = gs_none;
+		break;
+	case gs_none:
+		break;
+	}
+}
+
+void
+Pdtoken::file_exit(Fileid fid, bool ends_in_newline)
+{
+	if (guard_scans.empty() || guard_scans.back().fid != fid)
+		return;
+	const GuardScan &g = guard_scans.back();
+	/*
+	 * Without a final newline the file's last token may have been
+	 * read together with the includer's first characters.
+	 */
+	if (g.state == gs_end && g.guard.defined && ends_in_newline) {
+		if (DP())
+			cout << "Include guard " << g.guard.macro << " for " << fid.get_path() << '\n';
+		include_guards[fid] = g.guard;
+	}
+	guard_scans.pop_back();
+}
+
+void
+Pdtoken::guard_define(const Token &t)
+{
+	if (guard_scans.empty())
+		return;
+	IncludeGuard &g = guard_scans.back().guard;
+	if (guard_scans.back().state == gs_guarded &&
+	    guard_scans.back().depth == 1 && !g.defined &&
+	    t.get_val() == g.macro) {
+		g.def = t.get_parts_begin()->get_tokid();
+		g.defined = true;
+	}
+}
+
+bool
+Pdtoken::skip_guarded(Fileid fid)
+{
+	map <Fileid, IncludeGuard>::const_iterator i = include_guards.find(fid);
+	if (i == include_guards.end())
+		return false;
+	const IncludeGuard &g = i->second;
+	/*
+	 * The file's guard macro may have been defined elsewhere, or the
+	 * file may have been read in an earlier compilation unit.
+	 */
+	mapMacro::const_iterator m = macros.find(g.macro);
+	if (!macro_is_defined(m) ||
+	    m->second.get_name_token().get_parts_begin()->get_tokid() != g.def)
+		return false;
+	// The file's tokens would count towards the function's metrics
+	if (Call::collecting_metrics())
+		return false;
+	if (DP())
+		cout << "Skip guarded " << fid.get_path() << '\n';
+	// What processing the #ifndef and reading the file would record
+	Token::unify(m->second.get_name_token(), g.test);
+	Fdep::add_include(Fchar::get_fileid(), fid, Fchar::get_line_num() - 1);
+	fid.set_attribute(Project::get_current_projid());
+	return true;
+}
+
 void
 Pdtoken::getnext()
 {
@@ -137,6 +237,8 @@ again:
 			at_bol = false;
 		}
 	}
+	if (t.get_code() != SPACE && t.get_code() != '\n')
+		guard_token();
 	if (skiplevel) {
 		if (t.get_code() == '\n')
 			at_bol = true;
@@ -205,6 +307,8 @@ again:
 		} else
 			at_bol = false;
 	}
+	if (t.get_code() != SPACE && t.get_code() != '\n')
+		guard_token();
 	if (skiplevel) {
 		if (t.get_code() == '\n')
 			at_bol = true;
@@ -517,6 +621,13 @@ Pdtoken::process_ifdef(bool isndef)
 			 * directive is not a legal identifier
 			 */
 			Error::error(E_WARN, "#ifdef argument is not an identifier");
+		else if (isndef && !guard_scans.empty()) {
+			GuardScan &g = guard_scans.back();
+			if (g.state == gs_guarded && g.depth == 1 && g.guard.macro.empty()) {
+				g.guard.macro = t.get_val();
+				g.guard.test = t;
+			}
+		}
 		mapMacro::const_iterator i = macros.find(t.get_val());
 		if (i == macros.end())
 			// Heuristic; assume macro, even if it is not defined
@@ -606,17 +717,146 @@ Pdtoken::process_endif()
 	eat_to_eol();
 }
 
+/*
+ * Include file resolution cache.
+ * Searching the include path for a file tries to open it in each
+ * directory, and identifying the file found requires a stat call.
+ * Thousands of compilation units include the same headers through
+ * the same include path, so the outcome of each search is cached
+ * for the current directory and include path.
+ * Files are probed only once, and only if they appear in their
+ * directory's listing, which is read once.
+ */
+
+// An #include to resolve
+struct IncludeKey {
+	string dir;		// Including file's directory, if searched
+	int start;		// Include path offset to search from
+	string name;		// File name specified
+	IncludeKey(const string &d, int s, const string &n) :
+		dir(d), start(s), name(n) {}
+};
+
+static bool
+operator <(const IncludeKey &a, const IncludeKey &b)
+{
+	if (a.start != b.start)
+		return a.start < b.start;
+	if (a.name != b.name)
+		return a.name < b.name;
+	return a.dir < b.dir;
+}
+
+// The result of resolving an #include
+struct IncludeResult {
+	string fname;		// Path of the file found; empty if none
+	Fileid fid;		// and its identifier
+	int offset;		// Include path offset where found, or -1
+};
+
+typedef map <IncludeKey, IncludeResult> IncludeTable;
+// Resolved includes by current directory and include path
+static map <pair <string, vectorstring>, IncludeTable> include_tables;
+// Table for the current state; NULL when the directory or path changed
+static IncludeTable *include_table;
+static string cwd;			// Current directory; empty if changed
+
+// Called when the current directory or the include path change
+void
+Pdtoken::include_state_changed(bool dir)
+{
+	include_table = NULL;
+	if (dir)
+		cwd.clear();
+}
+
+// Return the current directory
+static const string &
+get_cwd()
+{
+	if (cwd.empty())
+		cwd = get_full_path(".");
+	return cwd;
+}
+
+// The entries of a directory, as used for resolving include files
+struct DirListing {
+	bool listed;		// False if the directory can't be listed
+	set <string> entries;	// Names of the directory's entries
+	DirListing() : listed(false) {}
+};
+
 // Return true if we can open a given file
 static bool
 can_open(const string& s)
 {
+	static map <string, bool> probed;	// Results by absolute path
+	static map <string, DirListing> listings;	// By absolute path
+
+	string path(is_absolute_filename(s) ? s : get_cwd() + "/" + s);
+	map <string, bool>::const_iterator pi = probed.find(path);
+	if (pi != probed.end())
+		return pi->second;
+
+	string::size_type slash = path.find_last_of("/\\");
+	string dir(path, 0, slash), base(path, slash + 1);
+	map <string, DirListing>::iterator li = listings.find(dir);
+	if (li == listings.end()) {
+		li = listings.insert(make_pair(dir, DirListing())).first;
+		li->second.listed = read_dir(dir.c_str(), li->second.entries);
+	}
+	// Names missing from a listing need not be probed or remembered
+	if (li->second.listed && li->second.entries.find(base) == li->second.entries.end())
+		return false;
+
 	ifstream in;
 	in.open(s.c_str());
-	if (!in.fail()) {
+	bool ret = !in.fail();
+	if (ret)
 		in.close();
-		return (true);
-	} else
-		return (false);
+	probed[path] = ret;
+	return ret;
+}
+
+/*
+ * Search for the file name specified in an #include.
+ * If local is true search first in the including file's directory,
+ * and then in the include path from the offset start.
+ */
+static const IncludeResult &
+resolve_include(const vectorstring &include_path, const string &name,
+    bool local, int start)
+{
+	if (include_table == NULL)
+		include_table = &include_tables[make_pair(get_cwd(), include_path)];
+	IncludeKey key(local ? Fchar::get_dir() : string(), start, name);
+	IncludeTable::iterator ti = include_table->find(key);
+	if (ti != include_table->end())
+		return ti->second;
+
+	IncludeResult &r = (*include_table)[key];
+	r.offset = -1;
+	if (is_absolute_filename(name)) {
+		if (can_open(name))
+			r.fname = name;
+	} else {
+		if (local) {
+			string fname(key.dir + "/" + name);
+			if (can_open(fname))
+				r.fname = fname;
+		}
+		for (int i = start; r.fname.empty() && i < (int)include_path.size(); i++) {
+			string fname(include_path[i] + "/" + name);
+			if (DP()) cout << "Try open " << fname << "\n";
+			if (can_open(fname)) {
+				r.fname = fname;
+				r.offset = i;
+			}
+		}
+	}
+	if (!r.fname.empty())
+		r.fid = Fileid(r.fname);
+	return r;
 }
 
 /*
@@ -633,6 +873,11 @@ Pdtoken::process_include(bool next)
 	if (skiplevel >= 1)
 		return;
 	Fchar::get_fileid().metrics().add_incfile();
+	if (shard_skip) {
+		// The included file sets up a unit of another shard
+		eat_to_eol();
+		return;
+	}
 	// Get tokens till end of line
 	Pltoken::set_context(cpp_include);
 	do {
@@ -690,48 +935,31 @@ Pdtoken::process_include(bool next)
 		cout << "Ready to include:\n";
 		copy(tokens.begin(), tokens.end(), ostream_iterator<Ptoken>(cout));
 	}
-	// #include <foo.h> and #include "foo.h"
-	if (is_absolute_filename(f.get_val())) {
-		if (can_open(f.get_val())) {
-			if (!Pdtoken::shall_skip(Fileid(f.get_val())))
-				Fchar::push_input(f.get_val());
+	/*
+	 * #include <foo.h> and #include "foo.h"
+	 * Where to search for "foo.h" is implementation specific.
+	 * - Harbison and Steele recommend in the current dir (p. 45)
+	 * - gcc 3.4.2 searches:
+	 * 1) in the including file's dir
+	 * 2) in the specified include path
+	 * - Microsoft C 11.0.7922 searches:
+	 * 1) in the including file's dir
+	 * 2) in the current directory
+	 * 3) in the specified include path
+	 */
+	const IncludeResult &r = resolve_include(include_path, f.get_val(),
+	    f.get_code() == ABSFNAME && !next,
+	    next ? Fchar::get_fileid().get_ipath_offset() + 1 : 0);
+	if (!r.fname.empty()) {
+		includes_resolved++;
+		if (Pdtoken::shall_skip(r.fid))
 			return;
-		}
-	} else {
-		/*
-		 * #include "foo.h"
-		 * Where to search is implementation specific.
-		 * - Harbison and Steele recommend in the current dir (p. 45)
-		 * - gcc 3.4.2 searches:
-		 * 1) in the including file's dir
-		 * 2) in the specified include path
-		 * - Microsoft C 11.0.7922 searches:
-		 * 1) in the including file's dir
-		 * 2) in the current directory
-		 * 3) in the specified include path
-		 */
-		if (f.get_code() == ABSFNAME && !next) {
-			string fname(Fchar::get_dir() + "/" + f.get_val());
-			if (can_open(fname)) {
-				if (!Pdtoken::shall_skip(Fileid(fname)))
-					Fchar::push_input(fname);
-				return;
-			}
-		}
-		vectorstring::iterator i;
-		i = include_path.begin();
-		if (next)
-			i += Fchar::get_fileid().get_ipath_offset() + 1;
-		for (; i < include_path.end(); i++) {
-			string fname(*i + "/" + f.get_val());
-			if (DP()) cout << "Try open " << fname << "\n";
-			if (can_open(fname)) {
-				if (!Pdtoken::shall_skip(Fileid(fname)))
-					Fchar::push_input(fname);
-				Fchar::get_fileid().set_ipath_offset(i - include_path.begin());
-				return;
-			}
-		}
+		if (skip_guarded(r.fid))
+			return;
+		Fchar::push_input(r.fname, r.fid);
+		if (r.offset != -1)
+			Fchar::get_fileid().set_ipath_offset(r.offset);
+		return;
 	}
 	/*
 	 * @error
@@ -772,6 +1000,7 @@ Pdtoken::process_define(bool is_immutable)
 	t.set_ec_attribute(is_macro);
 	Pltoken nametok = t;
 	name = t.get_val();
+	guard_define(nametok);
 	t.getnext<Fchar>();	// Space is significant: a(x) vs a (x)
 	bool is_function = (t.get_code() == '(');
 	Macro m(nametok, true, is_function, is_immutable);
@@ -1098,6 +1327,23 @@ Pdtoken::process_pragma()
 			return;
 		}
 		Project::set_current_project(t.get_val());
+		if (nshards && Block::get_scope_level() != -1)
+			/*
+			 * @error
+			 * A
+			 * <code>#pragma project</code>
+			 * CScout-specific directive appeared within a
+			 * <code>#pragma block_enter</code> block.
+			 * The projects of such a workspace share their
+			 * identifiers with external linkage, and can therefore
+			 * not be processed in separate shards.
+			 * Enclose each project in its own block, as
+			 * <em>cswc</em> does.
+			 */
+			Error::error(E_FATAL, "#pragma project: a project within a block can not be processed in a shard");
+		if (nshards)
+			shard_skip = (nprojects % nshards != shard);
+		nprojects++;
 	} else if (t.get_val() == "readonly") {
 		t.getnext_nospc<Fchar>();
 		if (t.get_code() != STRING_LITERAL) {
@@ -1128,6 +1374,12 @@ Pdtoken::process_pragma()
 			eat_to_eol();
 			return;
 		}
+		nunits++;
+		if (shard_skip) {
+			// The file belongs to another shard
+			eat_to_eol();
+			return;
+		}
 		if (preprocessed_output_spec.isSet()) {
 			// Skip or enable preprocessed output
 			if (preprocessed_output_spec.exec( t.get_val().c_str(),
@@ -1141,11 +1393,17 @@ Pdtoken::process_pragma()
 
 			Fchar::push_input(t.get_val());
 			Fchar::lock_stack();
+			Profile::begin("parse", t.get_val());
 			if (parse_parse() != 0)
 				exit(1);
+			Profile::end();
+			Profile::begin("garbage_collect", t.get_val());
 			garbage_collect(Fileid(t.get_val()));
+			Profile::end();
 			Fchar::unlock_stack();
 		}
+		// The tokens of the unit, and thus their hide sets, are gone
+		HideSets::clear();
 	} else if (t.get_val() == "pushd") {
 		char buff[4096];
 
@@ -1174,6 +1432,7 @@ Pdtoken::process_pragma()
 		}
 		if (chdir(t.get_val().c_str()) != 0)
 			Error::error(E_FATAL, "chdir " + t.get_val() + ": " + string(strerror(errno)));
+		include_state_changed(true);
 	} else if (t.get_val() == "popd") {
 		if (dirstack.empty()) {
 			/*
@@ -1192,6 +1451,7 @@ Pdtoken::process_pragma()
 		if (chdir(dirstack.top().c_str()) != 0)
 			Error::error(E_FATAL, "popd: " + dirstack.top() + ": " + string(strerror(errno)));
 		dirstack.pop();
+		include_state_changed(true);
 	} else if (t.get_val() == "clear_include") {
 		Pdtoken::clear_include();
 		Pdtoken::clear_skipped();
@@ -1233,6 +1493,8 @@ Pdtoken::process_directive()
 		return;
 	if (DP())
 		cout << "Directive: " << t << "\n";
+	const string d(t.get_val());
+	guard_directive(d);
 	if (t.get_code() != IDENTIFIER) {
 		/*
 		 * @error
@@ -1243,42 +1505,42 @@ Pdtoken::process_directive()
 		eat_to_eol();
 		return;
 	}
-	if (t.get_val() == "define")
+	if (d == "define")
 		process_define(false);
-	else if (t.get_val() == "include_next") // GCC extension
+	else if (d == "include_next") // GCC extension
 		process_include(true);
-	else if (t.get_val() == "include")
+	else if (d == "include")
 		process_include(false);
-	else if (t.get_val() == "if")
+	else if (d == "if")
 		process_if();
-	else if (t.get_val() == "ifdef")
+	else if (d == "ifdef")
 		process_ifdef(false);
-	else if (t.get_val() == "ifndef")
+	else if (d == "ifndef")
 		process_ifdef(true);
-	else if (t.get_val() == "elif")
+	else if (d == "elif")
 		process_elif();
-	else if (t.get_val() == "else")
+	else if (d == "else")
 		process_else();
-	else if (t.get_val() == "endif")
+	else if (d == "endif")
 		process_endif();
-	else if (t.get_val() == "undef")
+	else if (d == "undef")
 		process_undef();
-	else if (t.get_val() == "line")
+	else if (d == "line")
 		process_line();
-	else if (t.get_val() == "error")
+	else if (d == "error")
 		process_error(E_ERR);
-	else if (t.get_val() == "warning")	// GCC extension
+	else if (d == "warning")	// GCC extension
 		process_error(E_WARN);
-	else if (t.get_val() == "pragma")
+	else if (d == "pragma")
 		process_pragma();
-	else if (t.get_val() == "ident")	// GCC extension
+	else if (d == "ident")	// GCC extension
 		eat_to_eol();
 	else
 		/*
 		 * @error
 		 * An unkown preprocessor directive was found.
 		 */
-		Error::error(E_ERR, "Unknown preprocessor directive: " + t.get_val());
+		Error::error(E_ERR, "Unknown preprocessor directive: " + d);
 }
 
 
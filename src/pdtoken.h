@@ -31,6 +31,7 @@
 #include <list>
 #include <set>
 #include <map>
+#include <unordered_map>
 #include <stack>
 #include <vector>
 
@@ -56,7 +57,8 @@ typedef vector<Pdtoken> vectorPdtoken;
 
 class Macro;
 
-typedef map<string, Macro> mapMacro;
+// Consulted for every identifier, so hashed rather than ordered
+typedef unordered_map<string, Macro> mapMacro;
 
 class Pdtoken: public Ptoken {
 private:
@@ -72,6 +74,11 @@ private:
 	static vectorstring include_path;	// Include file path
 	static vectorPdtoken current_line;	// Currently read line
 	static CompiledRE preprocessed_output_spec;// Files to preprocess
+	static int shard, nshards;		// Projects we process (see set_shard)
+	static int nprojects;			// Projects encountered so far
+	static int nunits;			// Compilation units encountered so far
+	static bool shard_skip;			// True when skipping a project's files
+	static unsigned long includes_resolved;	// Include directives resolved
 
 	static void process_directive();	// Handle a cpp directive
 	static void eat_to_eol();		// Consume input including \n
@@ -103,6 +110,51 @@ private:
 	// Add a file to the list of files that shall not be included.
 	// (After encountering a #pragma once directive.)
 	static void set_skip(Fileid fid) { skipped_includes.insert(fid); }
+
+	/*
+	 * Multiple-include guard detection.
+	 * A file whose contents, apart from white space and comments,
+	 * are enclosed in an #ifndef X ... #endif block that defines X,
+	 * need not be read again while that definition of X is in effect.
+	 */
+	enum e_guard_state {
+		gs_start,		// Nothing read yet
+		gs_guarded,		// Within the #ifndef block
+		gs_end,			// After the block's #endif
+		gs_none,		// The file is not guarded
+	};
+	struct IncludeGuard {
+		string macro;		// Guard macro; empty if not known
+		Token test;		// The macro's token in the #ifndef
+		Tokid def;		// The macro's token in the file's #define
+		bool defined;		// True if def has been found
+		IncludeGuard() : defined(false) {}
+	};
+	struct GuardScan {
+		Fileid fid;		// File being read
+		e_guard_state state;
+		int depth;		// Conditional nesting within the guard
+		IncludeGuard guard;
+		GuardScan(Fileid f) : fid(f), state(gs_start), depth(0) {}
+	};
+	static vector <GuardScan> guard_scans;	// For the files being read
+	static map <Fileid, IncludeGuard> include_guards;	// Files' guards
+
+	// Note a token outside a directive
+	static void guard_token() {
+		if (!guard_scans.empty() && guard_scans.back().state != gs_guarded)
+			guard_scans.back().state = gs_none;
+	}
+	// Note the directive name
+	static void guard_directive(const string &name);
+	// Note the guard macro's definition
+	static void guard_define(const Token &t);
+	/*
+	 * Return true if the file fid need not be read, because its guard
+	 * macro is defined by the file itself, after recording what
+	 * reading it would record
+	 */
+	static bool skip_guarded(Fileid fid);
 	// Get the next expanded token
 	void getnext_expand();
 public:
@@ -132,6 +184,19 @@ public:
 		return macros.size();
 	}
 
+	/*
+	 * Return the ordinal of the compilation unit being processed.
+	 * It is the same in all shards of a workspace, and thus orders
+	 * the processing of their units.
+	 */
+	static int get_unit() { return nunits; }
+
+	// Return the number of projects encountered so far
+	static int get_projects() { return nprojects; }
+
+	// Return the number of include directives resolved
+	static unsigned long get_includes_resolved() { return includes_resolved; }
+
 	// Find a macro given its name
 	static mapMacro::const_iterator macros_find(const string& s) { return macros.find(s); }
 	// Undefined macro returned by find
@@ -141,13 +206,24 @@ public:
 	// Add to the macros map an undefined macro
 	static void create_undefined_macro(const Ptoken &name);
 	// Add an element in the include path
-	static void add_include(const string& s) { include_path.push_back(s); };
+	static void add_include(const string& s) {
+		include_path.push_back(s);
+		include_state_changed(false);
+	};
 	// Clear the include path
-	static void clear_include() { include_path.clear(); };
+	static void clear_include() {
+		include_path.clear();
+		include_state_changed(false);
+	};
+	// Invalidate cached include file searches (after chdir if dir)
+	static void include_state_changed(bool dir);
 	// Called when we start processing a new file
 	// or resume an old one.  We assume that files end in line
 	// boundaries, even when they lack an explicit newline at their end
 	static void file_switch() { at_bol = true; };
+	// Called when an included file is entered and exited
+	static void file_enter(Fileid fid) { guard_scans.push_back(GuardScan(fid)); }
+	static void file_exit(Fileid fid, bool ends_in_newline);
 	// Return the macro where a given token resides
 	static MCall *get_body_token_macro_mcall(Tokid t);
 	// Return true if we are currently skipping due to conditional compilation
@@ -162,6 +238,16 @@ public:
 	static void set_preprocessed_output(CompiledRE cre) {
 		preprocessed_output_spec = cre;
 	}
+	/*
+	 * Process only the files of shard s out of n.
+	 * Projects are assigned to shards round-robin in the order
+	 * they appear; files outside a project belong to shard 0.
+	 */
+	static void set_shard(int s, int n) {
+		shard = s;
+		nshards = n;
+		shard_skip = (s != 0);
+	}
 };
 
 ostream& operator<<(ostream& o,const dequePtoken &dp);
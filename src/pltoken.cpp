@@ -19,6 +19,7 @@
 #include <list>
 #include <vector>
 #include <set>
+#include <cstring>
 
 #include "cpp.h"
 #include "debug.h"
@@ -36,6 +37,94 @@
 enum e_cpp_context Pltoken::context = cpp_normal;
 bool Pltoken::semicolon_line_comments;
 bool Pltoken::echo;
+unsigned long Pltoken::count;		// Tokens lexed
+vector <map <int, PltokenCached> > Pltoken::cache;
+
+bool
+Pltoken::is_delimiter(int code)
+{
+	return code > 0 && code < 256 && strchr("\n[]()~?:,{}", code) != NULL;
+}
+
+/*
+ * Lex a token from the current file.
+ * Headers are typically included by many compilation units, so the
+ * tokens of included files are cached the first time they are lexed,
+ * and replayed on subsequent inclusions, provided that the lexical
+ * analysis starts from the same state.
+ * Replaying re-establishes the token's equivalence classes and
+ * processes the lines it spans, so that it has the same effect as
+ * lexing the token's characters.
+ * Tokens that span files or cause an error or warning are not cached.
+ */
+void
+Pltoken::lex_cached()
+{
+	int stream, back_val, back_offset;
+
+	if (!Fchar::is_included() || Fchar::is_yacc_file() ||
+	    semicolon_line_comments ||
+	    !Fchar::get_read_state(stream, back_val, back_offset)) {
+		lex<Fchar>();
+		return;
+	}
+	Fileid fi = Fchar::get_fileid();
+	if (cache.size() <= (unsigned)fi.get_id())
+		cache.resize(fi.get_id() + 1);
+	map <int, PltokenCached> &fcache = cache[fi.get_id()];
+	map <int, PltokenCached>::const_iterator ci = fcache.find(back_offset);
+	if (ci != fcache.end()) {
+		const PltokenCached &c = ci->second;
+		if (c.stream != stream || c.back_val != back_val ||
+		    c.context != context) {
+			// Different lexical state; don't replay
+			lex<Fchar>();
+			return;
+		}
+		code = c.code;
+		val = c.val;
+		parts.clear();
+		for (vector <pair <int, int> >::const_iterator i = c.runs.begin(); i != c.runs.end(); i++) {
+			vectorTpart new_tokids = Tokid(fi, i->first).constituents(i->second);
+			copy(new_tokids.begin(), new_tokids.end(), back_inserter(parts));
+		}
+		if (c.delimiter != -1)
+			t = Tokid(fi, c.delimiter);
+		if (code == '\n')
+			context = cpp_normal;
+		Fchar::set_read_state(c.end_stream, c.end_back_val,
+		    c.end_back_offset, c.lines, c.last_val);
+		return;
+	}
+
+	PltokenCached c;
+	c.stream = stream;
+	c.back_val = back_val;
+	c.context = context;
+	int line = Fchar::get_line_num();
+	int problems = Error::get_num_errors() + Error::get_num_warnings();
+	lex<Fchar>();
+	if (code == EOF || Fchar::get_fileid() != fi ||
+	    Error::get_num_errors() + Error::get_num_warnings() != problems ||
+	    !Fchar::get_read_state(c.end_stream, c.end_back_val, c.end_back_offset))
+		return;
+	for (vectorTpart::const_iterator i = parts.begin(); i != parts.end(); i++) {
+		Tokid ti(i->get_tokid());
+		if (ti.get_fileid() != fi || i->get_len() == 0)
+			return;
+		int offset = (int)ti.get_streampos();
+		if (!c.runs.empty() && c.runs.back().first + c.runs.back().second == offset)
+			c.runs.back().second += i->get_len();
+		else
+			c.runs.push_back(pair <int, int>(offset, i->get_len()));
+	}
+	c.code = code;
+	c.val = val;
+	c.delimiter = is_delimiter(code) ? (int)t.get_streampos() : -1;
+	c.lines = Fchar::get_line_num() - line;
+	c.last_val = Fchar::get_last_val();
+	fcache.insert(make_pair(back_offset, c));
+}
 
 #ifdef ndef
 ostream&
@@ -25,6 +25,9 @@
 #ifndef PLTOKEN_
 #define PLTOKEN_
 
+#include <map>
+#include <vector>
+
 #include "debug.h"
 #include "tokid.h"
 #include "ptoken.h"
@@ -39,17 +42,46 @@ enum e_cpp_context {
 	cpp_define	// Set while processing a #define directive (will recognize CONCAT)
 };
 
+/*
+ * A token lexed from an included file, kept for replaying it when the
+ * same file is included again.
+ * Positions are offsets in the file; the lexical analysis state
+ * before and after the token is recorded through the Fchar read state.
+ */
+struct PltokenCached {
+	int stream;			// Stream position before lexing
+	int back_val;			// Character put back before lexing
+	enum e_cpp_context context;	// Context before lexing
+	int code;			// Token code
+	string val;			// and value
+	vector <pair <int, int> > runs;	// Offset and length of contiguous parts
+	int delimiter;			// Offset of the delimiter Tokid
+	int end_stream;			// Stream position after lexing
+	int end_back_val;		// Character put back after lexing
+	int end_back_offset;		// and its offset
+	int lines;			// Lines read
+	int last_val;			// Last character read
+};
+
 // A C preprocessor lexical token
 class Pltoken: public Ptoken {
 private:
+	// Tokens lexed from included files, indexed by Fileid and offset
+	static vector <map <int, PltokenCached> > cache;
 	static enum e_cpp_context context;
 	// Allow line comments starting with a semicolon (inside Microsoft asm)
 	static bool semicolon_line_comments;
 	// Echo characters read on standard output
 	static bool echo;
+	static unsigned long count;	// Tokens lexed
 	template <class C> void update_parts(Tokid& base, Tokid& follow, const C& c0);
 	Tokid t;		// Token identifier for delimeters: comma, bracket
 	template <class C> void getnext_analyze();
+	template <class C> void lex();
+	// Lex from an Fchar source, replaying or caching the result
+	void lex_cached();
+	// Return true if a token with this code sets the delimiter Tokid
+	static bool is_delimiter(int code);
 public:
 	template <class C> void getnext();
 	template <class C> void getnext_nospc();
@@ -58,6 +90,8 @@ public:
 	Tokid get_delimiter_tokid() const { return t; }
 	static void set_echo() { echo = true; }
 	static void clear_echo() { echo = false; }
+	// Return the number of tokens lexed
+	static unsigned long get_count() { return count; }
 };
 
 /*
@@ -73,13 +107,33 @@ Pltoken::update_parts(Tokid& base, Tokid& follow, const C& c0)
 {
 	if (c0.get_tokid() != follow) {
 		// Discontinuity; save the Tokids we have
-		dequeTpart new_tokids = base.constituents(follow - base);
+		vectorTpart new_tokids = base.constituents(follow - base);
 		copy(new_tokids.begin(), new_tokids.end(),
 		     back_inserter(parts));
 		follow = base = c0.get_tokid();
 	}
 }
 
+/*
+ * Construct a preprocessor lexical token and account for it.
+ * Tokens read from files go through the token cache.
+ */
+template <class C>
+void
+Pltoken::getnext_analyze()
+{
+	if (C::is_file_source())
+		lex_cached();
+	else
+		lex<C>();
+	count++;
+	Call::process_token(*this);
+	// For metric counting filter out whitespace
+	if (code != SPACE && code != '\n')
+		Metrics::call_metrics(&Metrics::add_pptoken);
+	if (DP()) cout << "getnext returns: " << *this << "\n";
+}
+
 /*
  * Construct a preprocessor lexical token using Fchar as the class to
  * provide character input.
@@ -91,12 +145,12 @@ Pltoken::update_parts(Tokid& base, Tokid& follow, const C& c0)
  */
 template <class C>
 void
-Pltoken::getnext_analyze()
+Pltoken::lex()
 {
 	int n;
 	C c0, c1;
 	Tokid base, follow;
-	dequeTpart new_tokids;
+	vectorTpart new_tokids;
 
 	parts.clear();
 	c0.getnext();
@@ -432,7 +486,7 @@ Pltoken::getnext_analyze()
 			val += c0.get_char();
 		}
 		C::putback(c0);
-		dequeTpart new_tokids = base.constituents(follow - base);
+		vectorTpart new_tokids = base.constituents(follow - base);
 		copy(new_tokids.begin(), new_tokids.end(), back_inserter(parts));
 		// Later it will become TYPE_NAME, IDENTIFIER, or reserved word
 		code = IDENTIFIER;
@@ -559,11 +613,6 @@ Pltoken::getnext_analyze()
 	default:
 		val = (char)(code = c0.get_char());
 	}
-	Call::process_token(*this);
-	// For metric counting filter out whitespace
-	if (code != SPACE && code != '\n')
-		Metrics::call_metrics(&Metrics::add_pptoken);
-	if (DP()) cout << "getnext returns: " << *this << "\n";
 }
 
 template <class C>
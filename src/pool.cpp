@@ -0,0 +1,52 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * For documentation read the corresponding .h file
+ *
+ */
+
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#include "pool.h"
+
+Pool *Pool::pools[max_size / granularity + 1];
+
+// Make a new block the current one
+void
+Pool::new_block()
+{
+	size_t n = block_size / size;
+	next = new char[n * size];
+	end = next + n * size;
+	blocks.push_back(next);
+}
+
+void
+Pool::report(ostream &o)
+{
+	o << "Object size\tIn use\tPeak\tBlocks" << endl;
+	for (size_t i = 0; i <= max_size / granularity; i++)
+		if (pools[i])
+			o << pools[i]->size << '\t' <<
+			    pools[i]->in_use << '\t' <<
+			    pools[i]->peak << '\t' <<
+			    pools[i]->blocks.size() << endl;
+}
@@ -0,0 +1,108 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Pooled allocation of small objects that are created and destroyed
+ * in large numbers, such as equivalence classes and type nodes.
+ * Objects are carved out of large blocks and freed objects are kept
+ * in a per-size free list for reuse; the blocks are released in bulk
+ * at the end of the run.  Classes opt in by defining their operator
+ * new and delete through Pool::allocate and Pool::deallocate.
+ * The pools are not thread-safe; pooled objects are only created and
+ * deleted by the main thread.
+ *
+ * Include synopsis:
+ * #include <cstddef>
+ * #include <ostream>
+ * #include <vector>
+ *
+ */
+
+#ifndef POOL_
+#define POOL_
+
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+using namespace std;
+
+class Pool {
+private:
+	// Objects up to this size are pooled, in multiples of granularity
+	enum { granularity = 8, max_size = 256 };
+	// Size of the blocks objects are allocated from
+	static const size_t block_size = 64 * 1024;
+
+	struct Free {
+		Free *next;
+	};
+	size_t size;			// Size of the objects we allocate
+	Free *free_list;		// Objects available for reuse
+	char *next, *end;		// Unused part of the current block
+	vector <char *> blocks;		// All blocks we have allocated
+	size_t in_use, peak;		// Objects currently and maximally allocated
+
+	Pool(size_t s) : size(s), free_list(NULL), next(NULL), end(NULL), in_use(0), peak(0) {}
+	Pool(const Pool &);		// Not copyable
+	Pool &operator=(const Pool &);
+	void *alloc() {
+		if (++in_use > peak)
+			peak = in_use;
+		if (free_list) {
+			Free *f = free_list;
+			free_list = f->next;
+			return f;
+		}
+		if (next == end)
+			new_block();
+		void *p = next;
+		next += size;
+		return p;
+	}
+	void release(void *p) {
+		Free *f = static_cast<Free *>(p);
+		f->next = free_list;
+		free_list = f;
+		in_use--;
+	}
+	void new_block();
+	// The pools, indexed by size / granularity
+	static Pool *pools[max_size / granularity + 1];
+public:
+	static void *allocate(size_t s) {
+		if (s > max_size)
+			return ::operator new(s);
+		size_t i = (s + granularity - 1) / granularity;
+		if (pools[i] == NULL)
+			pools[i] = new Pool(i * granularity);
+		return pools[i]->alloc();
+	}
+	static void deallocate(void *p, size_t s) {
+		if (p == NULL)
+			return;
+		if (s > max_size)
+			::operator delete(p);
+		else
+			pools[(s + granularity - 1) / granularity]->release(p);
+	}
+	// Report the use of each pool
+	static void report(ostream &o);
+};
+
+#endif /* POOL_ */
@@ -0,0 +1,235 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * For documentation read the corresponding .h file
+ *
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <deque>
+#include <list>
+#include <stack>
+
+#include "cpp.h"
+#include "error.h"
+#include "attr.h"
+#include "metrics.h"
+#include "fileid.h"
+#include "tokid.h"
+#include "token.h"
+#include "ptoken.h"
+#include "macro.h"
+#include "pdtoken.h"
+#include "eclass.h"
+#include "call.h"
+#include "fchar.h"
+#include "pltoken.h"
+#include "fbuffer.h"
+#include "html.h"
+#include "profile.h"
+
+vector <Profile::Phase> Profile::phases;	// Phases recorded
+string Profile::fname;			// File to write
+double Profile::wall_begin, Profile::cpu_begin;	// Current phase start
+string Profile::name, Profile::unit;	// Current phase
+
+#if defined(unix) || defined(__unix__) || defined(__MACH__)
+
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+void
+Profile::get_usage(double &wall, double &cpu, long &peak_rss)
+{
+	struct timeval tv;
+	struct rusage ru;
+
+	gettimeofday(&tv, NULL);
+	getrusage(RUSAGE_SELF, &ru);
+	wall = tv.tv_sec + tv.tv_usec * 1e-6;
+	cpu = ru.ru_utime.tv_sec + ru.ru_utime.tv_usec * 1e-6 +
+		ru.ru_stime.tv_sec + ru.ru_stime.tv_usec * 1e-6;
+#ifdef __MACH__
+	peak_rss = ru.ru_maxrss / 1024;		// Bytes to KiB
+#else
+	peak_rss = ru.ru_maxrss;
+#endif
+}
+
+#else
+
+#include <windows.h>
+#include <psapi.h>
+
+void
+Profile::get_usage(double &wall, double &cpu, long &peak_rss)
+{
+	FILETIME creation_time, exit_time, kernel_time, user_time;
+	ULARGE_INTEGER user, kernel;
+	PROCESS_MEMORY_COUNTERS pmc;
+	HANDLE pid = GetCurrentProcess();
+
+	wall = GetTickCount64() * 1e-3;
+	GetProcessTimes(pid, &creation_time, &exit_time, &kernel_time, &user_time);
+	user.LowPart = user_time.dwLowDateTime;
+	user.HighPart = user_time.dwHighDateTime;
+	kernel.LowPart = kernel_time.dwLowDateTime;
+	kernel.HighPart = kernel_time.dwHighDateTime;
+	cpu = (user.QuadPart + kernel.QuadPart) * 1e-7;
+	if (GetProcessMemoryInfo(pid, &pmc, sizeof(pmc)))
+		peak_rss = (long)(pmc.PeakWorkingSetSize / 1024);
+	else
+		peak_rss = 0;
+}
+
+#endif // Unix / Windows
+
+void
+Profile::enable(const string &f)
+{
+	fname = f;
+	atexit(save);
+}
+
+void
+Profile::begin(const string &n, const string &u)
+{
+	if (!is_enabled())
+		return;
+	long peak_rss;
+	get_usage(wall_begin, cpu_begin, peak_rss);
+	name = n;
+	unit = u;
+}
+
+void
+Profile::end()
+{
+	if (!is_enabled() || name.empty())
+		return;
+	Phase p;
+	double wall, cpu;
+	get_usage(wall, cpu, p.peak_rss);
+	p.name = name;
+	p.unit = unit;
+	p.wall = wall - wall_begin;
+	p.cpu = cpu - cpu_begin;
+	p.tokid_map = Tokid::map_size();
+	p.eclasses = Eclass::get_count();
+	p.calls = Call::functions().size();
+	p.macros = Pdtoken::macros_size();
+	p.tokens = Pltoken::get_count();
+	p.bytes_read = Fbuffer::get_bytes_read();
+	p.includes = Pdtoken::get_includes_resolved();
+	phases.push_back(p);
+	name.clear();
+}
+
+// Return s as a JSON string
+static string
+json_string(const string &s)
+{
+	string r("\"");
+	for (string::const_iterator i = s.begin(); i != s.end(); i++)
+		switch (*i) {
+		case '"':
+		case '\\':
+			r += '\\';
+			r += *i;
+			break;
+		default:
+			if ((unsigned char)*i < ' ') {
+				char buff[10];
+				snprintf(buff, sizeof(buff), "\\u%04x", (unsigned char)*i);
+				r += buff;
+			} else
+				r += *i;
+		}
+	return r + '"';
+}
+
+void
+Profile::save()
+{
+	end();
+	FILE *f = fopen(fname.c_str(), "w");
+	if (f == NULL) {
+		/*
+		 * @error
+		 * The file specified with the -P option for writing
+		 * the analysis profile could not be opened
+		 */
+		Error::error(E_WARN, "Unable to open profile file " + fname + ": " + strerror(errno), false);
+		return;
+	}
+	write_json(f);
+	fclose(f);
+}
+
+void
+Profile::write_json(FILE *f)
+{
+	fputs("{\n\"phases\": [\n", f);
+	for (vector <Phase>::const_iterator i = phases.begin(); i != phases.end(); i++)
+		fprintf(f, "%s{\"phase\": %s, \"unit\": %s, "
+			"\"wall\": %.6f, \"cpu\": %.6f, \"peak_rss_kb\": %ld, "
+			"\"tokid_map\": %lu, \"eclasses\": %lu, \"calls\": %lu, "
+			"\"macros\": %lu, \"tokens\": %lu, \"bytes_read\": %lu, "
+			"\"includes\": %lu}",
+			i == phases.begin() ? "" : ",\n",
+			json_string(i->name).c_str(), json_string(i->unit).c_str(),
+			i->wall, i->cpu, i->peak_rss,
+			i->tokid_map, i->eclasses, i->calls, i->macros,
+			i->tokens, i->bytes_read, i->includes);
+	fputs("\n]\n}\n", f);
+}
+
+void
+Profile::html_page(FILE *of, void *p)
+{
+	html_head(of, "profile", "Analysis Profile");
+	fputs("<table class=\"metrics\"><tr>"
+		"<th>Phase</th><th>Unit</th>"
+		"<th>Wall time (s)</th><th>CPU time (s)</th><th>Peak RSS (kB)</th>"
+		"<th>Tokid map</th><th>Equivalence classes</th><th>Functions</th>"
+		"<th>Macros</th><th>Tokens</th><th>Bytes read</th><th>Includes</th>"
+		"</tr>\n", of);
+	for (vector <Phase>::const_iterator i = phases.begin(); i != phases.end(); i++)
+		fprintf(of, "<tr><td>%s</td><td>%s</td>"
+			"<td align=\"right\">%.3f</td><td align=\"right\">%.3f</td>"
+			"<td align=\"right\">%ld</td><td align=\"right\">%lu</td>"
+			"<td align=\"right\">%lu</td><td align=\"right\">%lu</td>"
+			"<td align=\"right\">%lu</td><td align=\"right\">%lu</td>"
+			"<td align=\"right\">%lu</td><td align=\"right\">%lu</td></tr>\n",
+			html(i->name).c_str(), html(i->unit).c_str(),
+			i->wall, i->cpu, i->peak_rss,
+			i->tokid_map, i->eclasses, i->calls, i->macros,
+			i->tokens, i->bytes_read, i->includes);
+	fputs("</table>\n", of);
+	fputs("<p><a href=\"profile.json\">JSON version</a>\n", of);
+	html_tail(of);
+}
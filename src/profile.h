@@ -0,0 +1,79 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * A profile of the analysis (-P).
+ * For each phase, such as the parsing of a compilation unit or the
+ * analysis of the identifiers, it records the wall clock and CPU time
+ * the phase took, the process's peak memory use, and the size of the
+ * main data structures and the work done so far at its end.
+ * The profile is written to a file as JSON when the program exits,
+ * and can also be viewed through the web interface.
+ *
+ * Include synopsis:
+ * #include <cstdio>
+ * #include <string>
+ * #include <vector>
+ *
+ */
+
+#ifndef PROFILE_
+#define PROFILE_
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class Profile {
+private:
+	// The record of a phase
+	struct Phase {
+		string name;		// Phase
+		string unit;		// Compilation unit, if any
+		double wall, cpu;	// Elapsed time (s)
+		long peak_rss;		// Peak resident set size (kB)
+		unsigned long tokid_map, eclasses, calls, macros;
+		unsigned long tokens, bytes_read, includes;
+	};
+	static vector <Phase> phases;	// Phases recorded
+	static string fname;		// File to write; empty if not profiling
+	static double wall_begin, cpu_begin;	// Current phase start
+	static string name, unit;	// Current phase
+
+	// Obtain the elapsed wall clock and CPU time, and the peak RSS
+	static void get_usage(double &wall, double &cpu, long &peak_rss);
+	// End the current phase and write the profile to fname
+	static void save();
+public:
+	// Record the profile and save it in file f on exit
+	static void enable(const string &f);
+	static bool is_enabled() { return !fname.empty(); }
+	// Start timing phase n, optionally for the compilation unit u
+	static void begin(const string &n, const string &u = "");
+	// Record the phase started by begin
+	static void end();
+	// Write the profile as JSON
+	static void write_json(FILE *of);
+	// Serve the profile as JSON and as a web page
+	static void json_page(FILE *of, void *p) { write_json(of); }
+	static void html_page(FILE *of, void *p);
+};
+
+#endif /* PROFILE_ */
@@ -45,7 +45,8 @@ operator<<(ostream& o,const Ptoken &t)
 {
 	o << (Token)t;
 	o << "Value: [" << t.val << "] HS(";
-	for (HideSet::const_iterator i = t.hideset.begin(); i != t.hideset.end(); i++)
+	const HideSet &hs(t.get_hideset());
+	for (HideSet::const_iterator i = hs.begin(); i != hs.end(); i++)
 		o << *i;
 	o << ')' << endl;
 	return (o);
@@ -60,10 +61,38 @@ ostream& operator<<(ostream& o,const PtokenSequence &t)
 	return (o);
 }
 
-Ptoken::Ptoken(const Ctoken &t) : Token(t)
+Ptoken::Ptoken(const Ctoken &t) : Token(t), hideset(NULL)
 {
 }
 
+set <HideSet> HideSets::sets;
+map <HideSets::HideSetPair, const HideSet *> HideSets::unions;
+const HideSet HideSets::empty;
+
+const HideSet *
+HideSets::intern(const HideSet &hs)
+{
+	if (hs.empty())
+		return NULL;
+	return &*sets.insert(hs).first;
+}
+
+const HideSet *
+HideSets::join(const HideSet *a, const HideSet *b)
+{
+	if (a == NULL || a == b)
+		return b;
+	if (b == NULL)
+		return a;
+	const HideSet *&r = unions[HideSetPair(a, b)];
+	if (r == NULL) {
+		HideSet u(*a);
+		u.insert(b->begin(), b->end());
+		r = intern(u);
+	}
+	return r;
+}
+
 #ifdef UNIT_TEST
 // cl -GX -DWIN32 -c eclass.cpp fileid.cpp tokid.cpp tokname.cpp token.cpp
 // cl -GX -DWIN32 -DUNIT_TEST ptoken.cpp token.obj tokid.obj eclass.obj tokname.obj fileid.obj kernel32.lib
@@ -27,8 +27,10 @@
 
 #include <iostream>
 #include <map>
+#include <set>
 #include <string>
 #include <deque>
+#include <utility>
 
 using namespace std;
 
@@ -42,21 +44,43 @@ class Ctoken;
 
 typedef set <Token> HideSet;
 
+/*
+ * Hide sets are interned: each distinct set is stored once, never
+ * changes, and is shared by all tokens carrying it.  This makes the
+ * many token copies made during macro expansion cheap, and allows
+ * the union of two sets to be computed once.
+ * The empty set is represented by NULL.
+ */
+class HideSets {
+private:
+	static set <HideSet> sets;	// All sets
+	typedef pair <const HideSet *, const HideSet *> HideSetPair;
+	static map <HideSetPair, const HideSet *> unions;
+public:
+	static const HideSet empty;
+	// Return the interned copy of hs
+	static const HideSet *intern(const HideSet &hs);
+	// Return the union of a and b
+	static const HideSet *join(const HideSet *a, const HideSet *b);
+	// Free all sets; no token may refer to them afterwards
+	static void clear() { unions.clear(); sets.clear(); }
+};
+
 class Ptoken : public Token {
 private:
-	HideSet hideset;	// Hide set used for macro expansions
+	const HideSet *hideset;	// Hide set used for macro expansions
 public:
 	// Construct it based on the token code and the contents
-	Ptoken(int icode, const string& ival) : Token(icode, ival) {};
+	Ptoken(int icode, const string& ival) : Token(icode, ival), hideset(NULL) {};
 	// Efficient constructor
-	Ptoken() {}
+	Ptoken() : hideset(NULL) {}
 	// Construct it from a CToken
 	Ptoken(const Ctoken &t);
 	// Accessor methods
-	inline bool hideset_contains(const Ptoken &t) const { return (hideset.find(t) != hideset.end()); }
-	inline void hideset_insert(Token t) { hideset.insert(t); }
-	inline void hideset_insert(HideSet::const_iterator b, HideSet::const_iterator e) { hideset.insert(b, e); }
-	inline const HideSet& get_hideset() const { return (hideset); }
+	inline bool hideset_contains(const Ptoken &t) const { return (hideset && hideset->find(t) != hideset->end()); }
+	// Add to the hide set the interned set hs
+	inline void hideset_insert(const HideSet *hs) { hideset = HideSets::join(hideset, hs); }
+	inline const HideSet& get_hideset() const { return (hideset ? *hideset : HideSets::empty); }
 	// Print it (for debugging)
 	friend ostream& operator<<(ostream& o,const Ptoken &t);
 	inline friend bool operator ==(const Ptoken& a, const Ptoken& b);
@@ -25,6 +25,7 @@
 # -TEST_CPP
 # -TEST_C
 # -TEST_OBFUSCATION
+# -TEST_SHARD
 #
 # To run a single test set the corresponding environment variable e.g.
 # CFILES=c36-endlabel.c ./runtest.sh -TEST_C
@@ -334,6 +335,97 @@ workspace TestWS {
 perl cswc.pl -d $DOTCSCOUT >makecs.cs 2>/dev/null
 }
 
+# Test that processing a workspace in shards, or updating it per
+# project (shards is update), gives the same results as processing
+# it in a single run
+# runtest_shard name csfile shards
+runtest_shard()
+{
+	NAME=$1
+	CSFILE=$2
+	SHARDS=$3
+	start_test . $NAME
+	OUT=test/nout/shard
+	rm -rf $OUT
+	mkdir -p $OUT/single $OUT/merged test/err/shard
+	(
+	LOAD=
+	if [ $SHARDS = update ]
+	then
+		$CSCOUT -c -U $OUT/ws $CSFILE >/dev/null || exit 1
+		LOAD="-L $OUT/ws"
+	else
+		i=0
+		while [ $i -lt $SHARDS ]
+		do
+			$CSCOUT -c -w $i/$SHARDS -S $OUT/$i.part $CSFILE >/dev/null || exit 1
+			LOAD="$LOAD -L $OUT/$i.part"
+			i=`expr $i + 1`
+		done
+	fi
+	for run in single merged
+	do
+		if [ $run = single ]
+		then
+			ARGS=$CSFILE
+		else
+			ARGS=$LOAD
+		fi
+		# The order of the identifiers and functions is not significant
+		$CSCOUT -r $ARGS 2>&1 >/dev/null |
+		grep -E '^[^ ]+:[0-9]+: [^ ]+: ' |
+		grep -v ': warning: ' |
+		sort >$OUT/$run/report
+		for graph in cgraph.txt 'fgraph.txt?gtype=I' 'fgraph.txt?gtype=C' \
+		    'fgraph.txt?gtype=G' 'fgraph.txt?gtype=F&n=D'
+		do
+			$CSCOUT -R "$graph" $ARGS >/dev/null || exit 1
+			BASE=`echo "$graph" | sed 's/?.*//'`
+			sort $BASE >$OUT/$run/`echo "$graph" | tr '?&=' ___`
+			rm -f $BASE
+		done
+	done
+	diff -r $OUT/single $OUT/merged
+	) >test/err/shard/$NAME 2>&1
+	if [ $? = 0 ]
+	then
+		end_test $NAME 1
+	else
+		end_test $NAME 0
+		show_error test/err/shard/$NAME
+	fi
+}
+
+# Create a CScout analysis workspace file of awk with overlapping projects
+makecs_shard()
+{
+	echo "
+workspace ShardWS {
+	directory ../example/awk {
+	project Prj1 {
+		define HAS_ISBLANK 1
+		file awkgram.y {
+			define yyclearin
+		}
+		file b.c lex.c
+	}
+	project Prj2 {
+		define HAS_ISBLANK 1
+		file lib.c main.c maketab.c
+	}
+	project Prj3 {
+		define HAS_ISBLANK 1
+		file parse.c proctab.c run.c tran.c
+	}
+	project Prj4 {
+		file lib.c tran.c
+	}
+	}
+}
+" |
+perl cswc.pl -d $DOTCSCOUT >makecs.cs 2>/dev/null
+}
+
 # Set the test control variables to the passed value
 set_test()
 {
@@ -342,6 +434,7 @@ set_test()
 	TEST_CPP=$1
 	TEST_C=$1
 	TEST_OBFUSCATION=$1
+	TEST_SHARD=$1
 }
 
 #
@@ -447,6 +540,17 @@ then
 	runtest_c awk.c ../example ../src awk.cs
 fi
 
+# Processing in shards
+if [ $TEST_SHARD = 1 ]
+then
+	TEST_GROUP=shard
+	makecs_shard
+	for i in 2 3 4 update
+	do
+		runtest_shard awk-$i makecs.cs $i
+	done
+fi
+
 # Finish priming
 if [ "$PRIME" = "1" ]
 then
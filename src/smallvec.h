@@ -0,0 +1,120 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * A vector that stores up to N elements inline, and only allocates
+ * heap memory when it grows beyond them.  It is used for sequences,
+ * such as the parts of a token, that are copied very often and almost
+ * always hold a single element.
+ * Only the operations the program needs are provided.  Iterators are
+ * plain pointers, which are invalidated when the vector is copied,
+ * modified, or destroyed.
+ *
+ * Include synopsis:
+ * #include <algorithm>
+ * #include <cstddef>
+ *
+ */
+
+#ifndef SMALLVEC_
+#define SMALLVEC_
+
+#include <algorithm>
+#include <cstddef>
+
+using namespace std;
+
+template <class T, size_t N>
+class SmallVector {
+private:
+	T local[N];		// Inline storage
+	T *elems;		// Elements; local or on the heap
+	size_t nelem;		// Number of elements
+	size_t capacity;	// Elements that fit in elems
+
+	bool is_local() const { return elems == local; }
+	// Ensure there is space for n elements
+	void reserve(size_t n) {
+		if (n <= capacity)
+			return;
+		size_t c = max(n, 2 * capacity);
+		T *e = new T[c];
+		copy(elems, elems + nelem, e);
+		if (!is_local())
+			delete[] elems;
+		elems = e;
+		capacity = c;
+	}
+	void assign(const T *b, const T *e) {
+		nelem = 0;
+		reserve(e - b);
+		copy(b, e, elems);
+		nelem = e - b;
+	}
+public:
+	typedef T value_type;
+	typedef T *iterator;
+	typedef const T *const_iterator;
+	typedef T &reference;
+	typedef const T &const_reference;
+	typedef size_t size_type;
+
+	SmallVector() : elems(local), nelem(0), capacity(N) {}
+	SmallVector(const SmallVector &v) : elems(local), nelem(0), capacity(N) {
+		assign(v.begin(), v.end());
+	}
+	template <class InputIterator>
+	SmallVector(InputIterator b, InputIterator e) : elems(local), nelem(0), capacity(N) {
+		for (; b != e; b++)
+			push_back(*b);
+	}
+	SmallVector &operator=(const SmallVector &v) {
+		if (this != &v)
+			assign(v.begin(), v.end());
+		return *this;
+	}
+	~SmallVector() {
+		if (!is_local())
+			delete[] elems;
+	}
+
+	iterator begin() { return elems; }
+	iterator end() { return elems + nelem; }
+	const_iterator begin() const { return elems; }
+	const_iterator end() const { return elems + nelem; }
+	size_type size() const { return nelem; }
+	bool empty() const { return nelem == 0; }
+	reference front() { return elems[0]; }
+	const_reference front() const { return elems[0]; }
+	reference back() { return elems[nelem - 1]; }
+	const_reference back() const { return elems[nelem - 1]; }
+
+	void push_back(const T &v) {
+		if (nelem == capacity) {
+			// v may be one of our elements
+			T t(v);
+			reserve(nelem + 1);
+			elems[nelem++] = t;
+		} else
+			elems[nelem++] = v;
+	}
+	// Remove all elements, keeping any allocated storage
+	void clear() { nelem = 0; }
+};
+
+#endif /* SMALLVEC_ */
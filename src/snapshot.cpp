@@ -0,0 +1,1128 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * For documentation read the corresponding .h file
+ *
+ */
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <stack>
+#include <deque>
+#include <list>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <stdint.h>
+#if defined(unix) || defined(__unix__) || defined(__MACH__)
+#include <unistd.h>		// access(2)
+#else
+#include <io.h>			// access(2)
+#endif
+
+#include "cpp.h"
+#include "debug.h"
+#include "error.h"
+#include "attr.h"
+#include "metrics.h"
+#include "fileid.h"
+#include "tokid.h"
+#include "fchar.h"
+#include "token.h"
+#include "ptoken.h"
+#include "macro.h"
+#include "compiledre.h"
+#include "pdtoken.h"
+#include "eclass.h"
+#include "type.h"
+#include "call.h"
+#include "fcall.h"
+#include "mcall.h"
+#include "funmetrics.h"
+#include "idquery.h"
+#include "globobj.h"
+#include "snapshot.h"
+#include "os.h"
+#include "md5.h"
+
+// Identify the file and the byte order of its integers
+static const char magic[8] = {'C', 'S', 'c', 'o', 'u', 't', 'W', 'S'};
+static const uint32_t byte_order = 0x01020304;
+
+bool Snapshot::partial;
+int Snapshot::input_id = -1;
+int Snapshot::nprojects;
+
+// Write the workspace in native byte order
+class SnapshotWriter {
+private:
+	ofstream out;
+	const string &fname;
+public:
+	SnapshotWriter(const string &f) : fname(f) {
+		out.open(fname.c_str(), ios::binary);
+		if (out.fail())
+			/*
+			 * @error
+			 * The file specified with the -S option could not be
+			 * created
+			 */
+			Error::error(E_FATAL, "Unable to open workspace snapshot " + fname + " for writing: " + strerror(errno), false);
+	}
+	void close() {
+		out.close();
+		if (out.fail())
+			/*
+			 * @error
+			 * Writing the workspace snapshot failed, for example
+			 * because the disk became full
+			 */
+			Error::error(E_FATAL, "Error writing workspace snapshot " + fname, false);
+	}
+	void bytes(const void *p, size_t n) { out.write((const char *)p, n); }
+	void u32(uint32_t v) { bytes(&v, sizeof(v)); }
+	void u64(uint64_t v) { bytes(&v, sizeof(v)); }
+	void i32(int v) { u32((uint32_t)v); }
+	void flag(bool v) { unsigned char c = v; bytes(&c, 1); }
+	void dbl(double v) { bytes(&v, sizeof(v)); }
+	void str(const string &s) { u32(s.length()); bytes(s.data(), s.length()); }
+	void fileid(Fileid f) { i32(f.get_id()); }
+	void tokid(Tokid t) { fileid(t.get_fileid()); u64((uint64_t)t.get_streampos()); }
+	void bits(const vector <bool> &v) {
+		u32(v.size());
+		for (vector <bool>::size_type i = 0; i < v.size(); i += 8) {
+			unsigned char c = 0;
+			for (int j = 0; j < 8 && i + j < v.size(); j++)
+				if (v[i + j])
+					c |= 1 << j;
+			bytes(&c, 1);
+		}
+	}
+	void fileidset(const set <Fileid> &s) {
+		u32(s.size());
+		for (set <Fileid>::const_iterator i = s.begin(); i != s.end(); i++)
+			fileid(*i);
+	}
+};
+
+// Read a memory-mapped workspace
+class SnapshotReader {
+private:
+	const string &fname;
+	const char *data;
+	size_t len;
+	size_t pos;
+	vector <int> remap;		// Workspace ids of the file ids read
+
+	// Return a pointer to the next n bytes
+	const char *take(size_t n) {
+		if (n > len - pos)
+			/*
+			 * @error
+			 * The workspace snapshot ended before all its
+			 * contents were read; it is probably incomplete
+			 */
+			Error::error(E_FATAL, "Truncated workspace snapshot " + fname, false);
+		const char *p = data + pos;
+		pos += n;
+		return p;
+	}
+public:
+	SnapshotReader(const string &f) : fname(f), pos(0) {
+		data = map_file(fname.c_str(), len);
+	}
+	~SnapshotReader() {
+		if (data)
+			unmap_file(data, len);
+	}
+	bool is_open() const { return data != NULL; }
+	bool at_end() const { return pos == len; }
+	void bytes(void *p, size_t n) { memcpy(p, take(n), n); }
+	uint32_t u32() { uint32_t v; bytes(&v, sizeof(v)); return v; }
+	uint64_t u64() { uint64_t v; bytes(&v, sizeof(v)); return v; }
+	int i32() { return (int)u32(); }
+	bool flag() { return *take(1) != 0; }
+	double dbl() { double v; bytes(&v, sizeof(v)); return v; }
+	string str() { uint32_t n = u32(); return string(take(n), n); }
+	Fileid fileid() {
+		int id = i32();
+		if (remap.empty())
+			return Fileid(id);
+		if (id < 0 || (unsigned)id >= remap.size())
+			/*
+			 * @error
+			 * A partial workspace snapshot refers to a
+			 * non-existent file
+			 */
+			Error::error(E_FATAL, "Corrupt workspace snapshot " + fname + ": invalid file", false);
+		return Fileid(remap[id]);
+	}
+	// Map the file ids read from now on through m
+	void set_remap(const vector <int> &m) { remap = m; }
+	Tokid tokid() { Fileid f(fileid()); return Tokid(f, (streampos)u64()); }
+	void bits(vector <bool> &v) {
+		v.resize(u32());
+		for (vector <bool>::size_type i = 0; i < v.size(); i += 8) {
+			unsigned char c = *take(1);
+			for (int j = 0; j < 8 && i + j < v.size(); j++)
+				v[i + j] = (c & (1 << j)) != 0;
+		}
+	}
+	void fileidset(set <Fileid> &s) {
+		for (uint32_t n = u32(); n > 0; n--)
+			s.insert(fileid());
+	}
+};
+
+void
+Snapshot::write_metrics(SnapshotWriter &w, const Metrics &m)
+{
+	w.u32(m.count.size());
+	for (vector <int>::const_iterator i = m.count.begin(); i != m.count.end(); i++)
+		w.i32(*i);
+	w.flag(m.processed);
+}
+
+void
+Snapshot::read_metrics(SnapshotReader &r, Metrics &m)
+{
+	m.count.resize(r.u32());
+	for (vector <int>::iterator i = m.count.begin(); i != m.count.end(); i++)
+		*i = r.i32();
+	m.processed = r.flag();
+}
+
+void
+Snapshot::write_idcount(SnapshotWriter &w, const IdCount &c)
+{
+	w.dbl(c.total);
+	w.u32(c.count.size());
+	for (vector <double>::const_iterator i = c.count.begin(); i != c.count.end(); i++)
+		w.dbl(*i);
+}
+
+void
+Snapshot::read_idcount(SnapshotReader &r, IdCount &c)
+{
+	c.total = r.dbl();
+	c.count.resize(r.u32());
+	for (vector <double>::iterator i = c.count.begin(); i != c.count.end(); i++)
+		*i = r.dbl();
+}
+
+// Projects and the attributes they occupy
+void
+Snapshot::write_projects(SnapshotWriter &w)
+{
+	w.u32(Attributes::size);
+	w.i32(Project::current_projid);
+	w.i32(Project::next_projid);
+	w.u32(Project::projnames.size());
+	for (vector <string>::const_iterator i = Project::projnames.begin(); i != Project::projnames.end(); i++)
+		w.str(*i);
+	w.u32(Project::projids.size());
+	for (map <string, int>::const_iterator i = Project::projids.begin(); i != Project::projids.end(); i++) {
+		w.str(i->first);
+		w.i32(i->second);
+	}
+}
+
+void
+Snapshot::read_projects(SnapshotReader &r)
+{
+	Attributes::size = r.u32();
+	Project::current_projid = r.i32();
+	Project::next_projid = r.i32();
+	Project::projnames.resize(r.u32());
+	for (vector <string>::iterator i = Project::projnames.begin(); i != Project::projnames.end(); i++)
+		*i = r.str();
+	Project::projids.clear();
+	for (uint32_t n = r.u32(); n > 0; n--) {
+		string name(r.str());
+		Project::projids[name] = r.i32();
+	}
+}
+
+// Verify that the projects of a partial workspace match ours
+void
+Snapshot::merge_projects(SnapshotReader &r)
+{
+	bool same = (r.u32() == Attributes::size);
+	r.i32();
+	r.i32();
+	uint32_t n = r.u32();
+	same = same && n == Project::projnames.size();
+	for (uint32_t i = 0; i < n; i++)
+		if (r.str() != (i < Project::projnames.size() ? Project::projnames[i] : ""))
+			same = false;
+	for (n = r.u32(); n > 0; n--) {
+		r.str();
+		r.i32();
+	}
+	if (!same)
+		/*
+		 * @error
+		 * The partial workspaces specified with the -L option
+		 * were not created from the same workspace definition file
+		 */
+		Error::error(E_FATAL, "Partial workspaces of different workspaces can not be merged", false);
+}
+
+// Write the include map m
+static void
+write_incmap(SnapshotWriter &w, const FileIncMap &m)
+{
+	w.u32(m.size());
+	for (FileIncMap::const_iterator i = m.begin(); i != m.end(); i++) {
+		w.fileid(i->first);
+		w.flag(i->second.is_directly_included());
+		w.flag(i->second.is_required());
+		const set <int> &lines = i->second.include_line_numbers();
+		w.u32(lines.size());
+		for (set <int>::const_iterator j = lines.begin(); j != lines.end(); j++)
+			w.i32(*j);
+	}
+}
+
+static void
+read_incmap(SnapshotReader &r, FileIncMap &m)
+{
+	for (uint32_t n = r.u32(); n > 0; n--) {
+		Fileid f(r.fileid());
+		bool direct = r.flag();
+		bool required = r.flag();
+		IncDetails d(direct, required);
+		for (uint32_t nl = r.u32(); nl > 0; nl--)
+			d.add_line(r.i32());
+		m.insert(FileIncMap::value_type(f, d));
+	}
+}
+
+// Add to a the includes of b
+static void
+merge_incmap(FileIncMap &a, const FileIncMap &b)
+{
+	for (FileIncMap::const_iterator i = b.begin(); i != b.end(); i++) {
+		FileIncMap::iterator ai = a.find(i->first);
+		if (ai == a.end())
+			ai = a.insert(*i).first;
+		else
+			ai->second.update(i->second.is_directly_included(), i->second.is_required());
+		const set <int> &lines = i->second.include_line_numbers();
+		for (set <int>::const_iterator j = lines.begin(); j != lines.end(); j++)
+			ai->second.add_line(*j);
+	}
+}
+
+// Return m with its file ids mapped through remap
+static FileIncMap
+remap_incmap(const FileIncMap &m, const vector <int> &remap)
+{
+	FileIncMap r;
+	for (FileIncMap::const_iterator i = m.begin(); i != m.end(); i++)
+		r.insert(FileIncMap::value_type(Fileid(remap[i->first.get_id()]), i->second));
+	return r;
+}
+
+static Fileidset
+remap_fileidset(const Fileidset &s, const vector <int> &remap)
+{
+	Fileidset r;
+	for (Fileidset::const_iterator i = s.begin(); i != s.end(); i++)
+		r.insert(Fileid(remap[i->get_id()]));
+	return r;
+}
+
+// File details; the functions defined in each file are set with the calls
+void
+Snapshot::write_files(SnapshotWriter &w)
+{
+	w.u32(Fileid::ro_prefix.size());
+	for (list <string>::const_iterator i = Fileid::ro_prefix.begin(); i != Fileid::ro_prefix.end(); i++)
+		w.str(*i);
+	w.u32(Fileid::u2i.size());
+	for (FI_uname_to_id::const_iterator i = Fileid::u2i.begin(); i != Fileid::u2i.end(); i++) {
+		w.str(i->first);
+		w.i32(i->second);
+	}
+	w.u32(Fileid::i2d.size());
+	for (FI_id_to_details::const_iterator i = Fileid::i2d.begin(); i != Fileid::i2d.end(); i++) {
+		w.str(i->name);
+		w.flag(i->m_garbage_collected);
+		w.flag(i->m_required);
+		w.i32(i->required_unit);
+		w.flag(i->m_compilation_unit);
+		w.u32(i->line_ends.size());
+		for (vector <streampos>::const_iterator j = i->line_ends.begin(); j != i->line_ends.end(); j++)
+			w.u64((uint64_t)*j);
+		w.bits(i->processed_lines);
+		write_incmap(w, i->includes);
+		write_incmap(w, i->includers);
+		w.u32(i->hash.size());
+		w.bytes(i->hash.data(), i->hash.size());
+		w.i32(i->ipath_offset);
+		w.fileidset(i->runtime_uses);
+		w.fileidset(i->runtime_used_by);
+		w.bits(i->attr.attr);
+		write_metrics(w, i->m);
+	}
+}
+
+void
+Snapshot::read_details(SnapshotReader &r, Filedetails &d)
+{
+	d.name = r.str();
+	d.m_garbage_collected = r.flag();
+	d.m_required = r.flag();
+	d.required_unit = r.i32();
+	d.m_compilation_unit = r.flag();
+	d.line_ends.resize(r.u32());
+	for (vector <streampos>::iterator j = d.line_ends.begin(); j != d.line_ends.end(); j++)
+		*j = (streampos)r.u64();
+	r.bits(d.processed_lines);
+	read_incmap(r, d.includes);
+	read_incmap(r, d.includers);
+	d.hash.resize(r.u32());
+	r.bytes(d.hash.data(), d.hash.size());
+	d.ipath_offset = r.i32();
+	r.fileidset(d.runtime_uses);
+	r.fileidset(d.runtime_used_by);
+	r.bits(d.attr.attr);
+	read_metrics(r, d.m);
+}
+
+void
+Snapshot::read_files(SnapshotReader &r)
+{
+	Fileid::ro_prefix.clear();
+	for (uint32_t n = r.u32(); n > 0; n--)
+		Fileid::ro_prefix.push_back(r.str());
+	Fileid::u2i.clear();
+	for (uint32_t n = r.u32(); n > 0; n--) {
+		string uname(r.str());
+		Fileid::u2i[uname] = r.i32();
+	}
+	Fileid::i2d.clear();
+	Fileid::identical_files.clear();
+	Fileid::i2d.resize(r.u32());
+	Fileid::counter = Fileid::i2d.size();
+	for (FI_id_to_details::size_type id = 0; id < Fileid::i2d.size(); id++) {
+		Filedetails &d = Fileid::i2d[id];
+		read_details(r, d);
+		Fileid::identical_files[d.hash].insert(Fileid(id));
+	}
+	Fileid::anonymous = Fileid(0);
+}
+
+// Add to a the details of the same file b, processed in another shard
+void
+Snapshot::merge_details(Filedetails &a, const Filedetails &b)
+{
+	// As in a single run, the last unit that set the flag decides it
+	if (b.required_unit > a.required_unit) {
+		a.m_required = b.m_required;
+		a.required_unit = b.required_unit;
+	}
+	a.m_compilation_unit = a.m_compilation_unit || b.m_compilation_unit;
+	if (a.processed_lines.size() < b.processed_lines.size())
+		a.processed_lines.resize(b.processed_lines.size());
+	for (vector <bool>::size_type i = 0; i < b.processed_lines.size(); i++)
+		if (b.processed_lines[i])
+			a.processed_lines[i] = true;
+	merge_incmap(a.includes, b.includes);
+	merge_incmap(a.includers, b.includers);
+	a.runtime_uses.insert(b.runtime_uses.begin(), b.runtime_uses.end());
+	a.runtime_used_by.insert(b.runtime_used_by.begin(), b.runtime_used_by.end());
+	if (a.attr.attr.size() < b.attr.attr.size())
+		a.attr.attr.resize(b.attr.attr.size());
+	for (vector <bool>::size_type i = 0; i < b.attr.attr.size(); i++)
+		if (b.attr.attr[i])
+			a.attr.attr[i] = true;
+	// As in a single run, the metrics come from the file's first processing
+	if (!a.m.is_processed() && b.m.is_processed())
+		a.m = b.m;
+}
+
+/*
+ * Add the files of a partial workspace to ours, matching them by name,
+ * and set r to map the file ids it reads to the ones of our files.
+ */
+void
+Snapshot::merge_files(SnapshotReader &r)
+{
+	for (uint32_t n = r.u32(); n > 0; n--) {
+		string prefix(r.str());
+		if (find(Fileid::ro_prefix.begin(), Fileid::ro_prefix.end(), prefix) == Fileid::ro_prefix.end())
+			Fileid::ro_prefix.push_back(prefix);
+	}
+	map <int, string> unames;
+	for (uint32_t n = r.u32(); n > 0; n--) {
+		string uname(r.str());
+		unames[r.i32()] = uname;
+	}
+	vector <Filedetails> details(r.u32());
+	for (vector <Filedetails>::iterator i = details.begin(); i != details.end(); i++)
+		read_details(r, *i);
+
+	vector <int> remap(details.size());
+	vector <bool> added(details.size());
+	for (vector <Filedetails>::size_type id = 0; id < details.size(); id++) {
+		map <int, string>::const_iterator u = unames.find(id);
+		if (u == unames.end())
+			/*
+			 * @error
+			 * A file in a partial workspace snapshot has no name
+			 */
+			Error::error(E_FATAL, "Corrupt workspace snapshot: unnamed file", false);
+		FI_uname_to_id::const_iterator w = Fileid::u2i.find(u->second);
+		if (w != Fileid::u2i.end())
+			remap[id] = w->second;
+		else {
+			remap[id] = Fileid::counter++;
+			Fileid::u2i[u->second] = remap[id];
+			added[id] = true;
+		}
+	}
+	Fileid::i2d.resize(Fileid::counter);
+	for (vector <Filedetails>::size_type id = 0; id < details.size(); id++) {
+		Filedetails &b = details[id];
+		b.includes = remap_incmap(b.includes, remap);
+		b.includers = remap_incmap(b.includers, remap);
+		b.runtime_uses = remap_fileidset(b.runtime_uses, remap);
+		b.runtime_used_by = remap_fileidset(b.runtime_used_by, remap);
+		if (added[id]) {
+			Fileid::i2d[remap[id]] = b;
+			Fileid::identical_files[b.hash].insert(Fileid(remap[id]));
+		} else
+			merge_details(Fileid::i2d[remap[id]], b);
+	}
+	r.set_remap(remap);
+}
+
+// Equivalence classes, and the identifiers that refer to them
+void
+Snapshot::write_ecs(SnapshotWriter &w)
+{
+	// Number the ECs in file and offset order
+	map <Eclass *, uint32_t> ecnum;
+	vector <Eclass *> ecs;
+	for (int i = 0; i <= Fileid::max_id(); i++)
+		Fileid(i).get_ec_index().for_each([&](cs_offset_t, Eclass *ec) {
+			if (ecnum.insert(make_pair(ec, (uint32_t)ecs.size())).second)
+				ecs.push_back(ec);
+		});
+	w.u32(ecs.size());
+	for (vector <Eclass *>::const_iterator i = ecs.begin(); i != ecs.end(); i++) {
+		Eclass *ec = *i;
+		w.i32(ec->get_len());
+		vector <bool> attr(Attributes::get_num_attributes());
+		for (vector <bool>::size_type j = 0; j < attr.size(); j++)
+			attr[j] = ec->get_attribute(j);
+		w.bits(attr);
+		const setTokid &members = ec->get_members();
+		w.u32(members.size());
+		for (setTokid::const_iterator j = members.begin(); j != members.end(); j++)
+			w.tokid(*j);
+	}
+
+	w.u32(Identifier::ids.size());
+	for (IdProp::const_iterator i = Identifier::ids.begin(); i != Identifier::ids.end(); i++) {
+		w.u32(ecnum[i->first]);
+		w.str(i->second.get_id());
+		w.flag(i->second.get_xfile());
+		w.flag(i->second.get_replaced());
+		w.str(i->second.get_newid());
+		w.flag(i->second.get_active());
+	}
+}
+
+void
+Snapshot::read_ecs(SnapshotReader &r)
+{
+	vector <Eclass *> ecs(r.u32());
+	for (vector <Eclass *>::iterator i = ecs.begin(); i != ecs.end(); i++) {
+		Eclass *ec = *i = new Eclass(r.i32());
+		r.bits(ec->attr.attr);
+		for (uint32_t n = r.u32(); n > 0; n--)
+			add_member(ec, r.tokid());
+	}
+
+	Identifier::ids.clear();
+	for (uint32_t n = r.u32(); n > 0; n--) {
+		uint32_t ecn = r.u32();
+		if (ecn >= ecs.size())
+			/*
+			 * @error
+			 * An identifier in the workspace snapshot refers
+			 * to a non-existent equivalence class
+			 */
+			Error::error(E_FATAL, "Corrupt workspace snapshot: invalid identifier", false);
+		Eclass *ec = ecs[ecn];
+		Identifier id(ec, r.str());
+		id.set_xfile(r.flag());
+		bool replaced = r.flag();
+		string newid(r.str());
+		if (replaced)
+			id.set_newid(newid);
+		id.set_active(r.flag());
+		Identifier::ids.insert(Identifier::ids.end(), IdProp::value_type(ec, id));
+	}
+}
+
+/*
+ * Add t to the members of ec, without adding ec to the current
+ * project, as Eclass::add_tokid does; the snapshot has its attributes.
+ */
+void
+Snapshot::add_member(Eclass *ec, Tokid t)
+{
+	ec->members.insert(t);
+	t.set_ec(ec);
+}
+
+/*
+ * Return the equivalence class starting at t and extending at most
+ * l characters.  Split an existing class that covers t or extends
+ * further, and create one if t is not covered.
+ */
+Eclass *
+Snapshot::ec_at(Tokid t, int l)
+{
+	Eclass *e = t.check_ec();
+	if (e == NULL) {
+		// Split the class starting before t, if it extends over it
+		cs_offset_t offset = (cs_offset_t)t.get_streampos(), start;
+		Eclass *c = t.get_fileid().get_ec_index().find_preceding(offset, start);
+		if (c != NULL && start + c->get_len() > offset)
+			e = c->split((int)(offset - start - 1));
+	}
+	if (e == NULL) {
+		int n = 1;
+		while (n < l && (t + n).check_ec() == NULL)
+			n++;
+		e = new Eclass(n);
+		add_member(e, t);
+		return e;
+	}
+	if (e->get_len() > l)
+		e->split(l - 1);
+	return e;
+}
+
+/*
+ * Add to our equivalence classes one of a partial workspace, which has
+ * the specified length, attributes, and members.
+ * The members may be covered by classes of different extents, so the
+ * classes covering them are first split to the same boundaries, and
+ * then the corresponding ones are merged.
+ */
+void
+Snapshot::merge_ec(int len, const vector <bool> &attr, const vector <Tokid> &members)
+{
+	set <int> bounds;
+	for (;;) {
+		// Find where the classes covering the members start
+		bounds.clear();
+		for (vector <Tokid>::const_iterator i = members.begin(); i != members.end(); i++)
+			for (int pos = 0; pos < len; pos += ec_at(*i + pos, len - pos)->get_len())
+				bounds.insert(pos);
+		// Split the classes at all these points
+		bool split = false;
+		for (vector <Tokid>::const_iterator i = members.begin(); i != members.end(); i++)
+			for (int pos = 0; pos < len; ) {
+				Eclass *e = (*i + pos).check_ec();
+				set <int>::const_iterator next = bounds.upper_bound(pos);
+				int end = (next == bounds.end()) ? len : *next;
+				if (pos + e->get_len() > end) {
+					e->split(end - pos - 1);
+					split = true;
+				}
+				pos = end;
+			}
+		// Splitting a class can add bounds to other members
+		if (!split)
+			break;
+	}
+	for (set <int>::const_iterator b = bounds.begin(); b != bounds.end(); b++) {
+		Eclass *ec = (members.front() + *b).check_ec();
+		for (vector <Tokid>::const_iterator i = members.begin() + 1; i != members.end(); i++)
+			ec = unite(ec, (*i + *b).check_ec());
+		for (vector <bool>::size_type j = 0; j < attr.size(); j++)
+			if (attr[j])
+				ec->set_attribute(j);
+	}
+}
+
+void
+Snapshot::merge_ecs(SnapshotReader &r)
+{
+	for (uint32_t n = r.u32(); n > 0; n--) {
+		int len = r.i32();
+		vector <bool> attr;
+		r.bits(attr);
+		vector <Tokid> members(r.u32());
+		for (vector <Tokid>::iterator i = members.begin(); i != members.end(); i++)
+			*i = r.tokid();
+		if (len > 0 && !members.empty())
+			merge_ec(len, attr, members);
+	}
+	if (r.u32() != 0)
+		/*
+		 * @error
+		 * A partial workspace snapshot contains identifiers,
+		 * which are only established when the workspace is
+		 * post-processed
+		 */
+		Error::error(E_FATAL, "Corrupt workspace snapshot: identifiers in partial workspace", false);
+}
+
+void
+Snapshot::write_token(SnapshotWriter &w, const Token &t)
+{
+	w.i32(t.code);
+	w.str(t.val);
+	w.u32(t.parts.size());
+	for (vectorTpart::const_iterator i = t.parts.begin(); i != t.parts.end(); i++) {
+		w.tokid(i->get_tokid());
+		w.i32(i->get_len());
+	}
+}
+
+Token
+Snapshot::read_token(SnapshotReader &r)
+{
+	Token tok(r.i32());
+	tok.val = r.str();
+	for (uint32_t n = r.u32(); n > 0; n--) {
+		Tokid t(r.tokid());
+		tok.parts.push_back(Tpart(t, r.i32()));
+	}
+	return tok;
+}
+
+void
+Snapshot::write_call(SnapshotWriter &w, const Call *c)
+{
+	w.flag(c->is_cfun());
+	w.str(c->name);
+	write_token(w, c->token);
+	w.i32(c->begin.get_line_number());
+	w.tokid(c->begin.get_tokid());
+	w.i32(c->end.get_line_number());
+	w.tokid(c->end.get_tokid());
+	write_metrics(w, c->m);
+	w.i32(c->processed_unit);
+	if (c->is_cfun()) {
+		const FCall *f = static_cast<const FCall *>(c);
+		w.tokid(f->definition);
+		w.flag(f->defined);
+		w.flag(f->type.is_static());
+		w.i32(f->defined_unit);
+		w.i32(f->declared_unit);
+	}
+}
+
+Call *
+Snapshot::read_call(SnapshotReader &r)
+{
+	bool is_cfun = r.flag();
+	string name(r.str());
+	Token tok(read_token(r));
+	int bline = r.i32();
+	Tokid btokid(r.tokid());
+	int eline = r.i32();
+	Tokid etokid(r.tokid());
+
+	Call *c;
+	if (is_cfun)
+		c = new FCall(tok, basic(), name);
+	else
+		c = new MCall(tok, name);
+	c->begin = FcharContext(bline, btokid);
+	c->end = FcharContext(eline, etokid);
+	read_metrics(r, c->m);
+	c->processed_unit = r.i32();
+	if (is_cfun) {
+		FCall *f = static_cast<FCall *>(c);
+		f->definition = r.tokid();
+		f->defined = r.flag();
+		// Only the storage class of the function's type is used
+		if (r.flag())
+			f->type = basic(b_abstract, s_none, c_static);
+		f->defined_unit = r.i32();
+		f->declared_unit = r.i32();
+	}
+	return c;
+}
+
+// Functions, macros, and the calls between them
+void
+Snapshot::write_calls(SnapshotWriter &w)
+{
+	map <const Call *, uint32_t> callnum;
+	w.u32(Call::all.size());
+	for (Call::const_fmap_iterator_type i = Call::all.begin(); i != Call::all.end(); i++) {
+		callnum.insert(make_pair(i->second, (uint32_t)callnum.size()));
+		write_call(w, i->second);
+	}
+	for (Call::const_fmap_iterator_type i = Call::all.begin(); i != Call::all.end(); i++) {
+		w.u32(i->second->call.size());
+		for (Call::const_fiterator_type j = i->second->call.begin(); j != i->second->call.end(); j++)
+			w.u32(callnum[*j]);
+	}
+}
+
+void
+Snapshot::read_calls(SnapshotReader &r)
+{
+	Call::all.clear();
+	vector <Call *> calls(r.u32());
+	for (vector <Call *>::iterator i = calls.begin(); i != calls.end(); i++) {
+		*i = read_call(r);
+		if ((*i)->is_span_valid())
+			(*i)->end.get_tokid().get_fileid().add_function(*i);
+	}
+	read_call_graph(r, calls);
+}
+
+// Register the calls between the entities in calls
+void
+Snapshot::read_call_graph(SnapshotReader &r, const vector <Call *> &calls)
+{
+	for (vector <Call *>::const_iterator i = calls.begin(); i != calls.end(); i++)
+		for (uint32_t n = r.u32(); n > 0; n--) {
+			uint32_t callee = r.u32();
+			if (callee >= calls.size())
+				/*
+				 * @error
+				 * A function call in the workspace snapshot refers
+				 * to a non-existent function
+				 */
+				Error::error(E_FATAL, "Corrupt workspace snapshot: invalid function call", false);
+			Call::register_call(*i, calls[callee]);
+		}
+}
+
+// Return a call other than c that has the same token, or NULL
+static Call *
+equal_call(Call *c, const Token &t)
+{
+	pair <Call::const_fmap_iterator_type, Call::const_fmap_iterator_type> maybe(Call::get_calls(t.get_parts_begin()->get_tokid()));
+	for (Call::const_fmap_iterator_type i = maybe.first; i != maybe.second; i++)
+		if (i->second != c && t.equals(i->second->get_token()))
+			return i->second;
+	return NULL;
+}
+
+/*
+ * Merge into e the same function or macro c of another shard.
+ * As in a single run, the span and the metrics come from the first
+ * processing of the body, the definition and the number of global
+ * namespace occupants from the last definition, and a C function's
+ * number of parameters from its last declaration.
+ */
+void
+Snapshot::merge_call(Call *e, const Call *c)
+{
+	vector <int> &count = e->m.count;
+	int ngnsoc = count[FunMetrics::em_ngnsoc];
+	int nparam = count[FunMetrics::em_nparam];
+	if (c->m.is_processed() &&
+	    (!e->m.is_processed() || c->processed_unit < e->processed_unit)) {
+		if (e->is_span_valid())
+			e->end.get_tokid().get_fileid().get_functions().erase(e);
+		static_cast<Metrics &>(e->m) = c->m;
+		e->begin = c->begin;
+		e->end = c->end;
+		e->processed_unit = c->processed_unit;
+		if (e->is_span_valid())
+			e->end.get_tokid().get_fileid().add_function(e);
+	}
+	if (!e->is_cfun() || !c->is_cfun())
+		return;
+	FCall *fe = static_cast<FCall *>(e);
+	const FCall *fc = static_cast<const FCall *>(c);
+	if (fc->defined_unit > fe->defined_unit) {
+		ngnsoc = fc->m.count[FunMetrics::em_ngnsoc];
+		fe->definition = fc->definition;
+		fe->defined_unit = fc->defined_unit;
+	}
+	fe->defined = fe->defined || fc->defined;
+	if (fc->declared_unit > fe->declared_unit) {
+		nparam = fc->m.count[FunMetrics::em_nparam];
+		fe->declared_unit = fc->declared_unit;
+	}
+	count[FunMetrics::em_ngnsoc] = ngnsoc;
+	count[FunMetrics::em_nparam] = nparam;
+}
+
+/*
+ * Add the functions and macros of a partial workspace to ours.
+ * Those also found in our workspace, through a common declaration,
+ * are merged with ours.
+ */
+void
+Snapshot::merge_calls(SnapshotReader &r)
+{
+	vector <Call *> calls(r.u32());
+	for (vector <Call *>::iterator i = calls.begin(); i != calls.end(); i++) {
+		Call *c = read_call(r);
+		Call *e = equal_call(c, c->token);
+		if (e == NULL) {
+			if (c->is_span_valid())
+				c->end.get_tokid().get_fileid().add_function(c);
+			*i = c;
+			continue;
+		}
+		merge_call(e, c);
+		pair <Call::fun_map::iterator, Call::fun_map::iterator> range(Call::all.equal_range(c->token.get_parts_begin()->get_tokid()));
+		for (Call::fun_map::iterator j = range.first; j != range.second; j++)
+			if (j->second == c) {
+				Call::all.erase(j);
+				break;
+			}
+		delete c;
+		*i = e;
+	}
+	read_call_graph(r, calls);
+}
+
+// Global objects, used for establishing the runtime file dependencies
+void
+Snapshot::write_globs(SnapshotWriter &w)
+{
+	w.u32(GlobObj::all.size());
+	for (GlobObj::glob_map::const_iterator i = GlobObj::all.begin(); i != GlobObj::all.end(); i++) {
+		const GlobObj *g = i->second;
+		w.str(g->name);
+		write_token(w, g->token);
+		w.fileidset(g->defined);
+		w.fileidset(g->used);
+	}
+}
+
+// Add the saved global objects to ours; they may already exist
+void
+Snapshot::read_globs(SnapshotReader &r)
+{
+	for (uint32_t n = r.u32(); n > 0; n--) {
+		string name(r.str());
+		Token tok(read_token(r));
+		GlobObj *g = GlobObj::get_glob(tok);
+		if (g == NULL)
+			// Only the objects' files are used after parsing
+			g = new GlobObj(tok, basic(), name);
+		r.fileidset(g->defined);
+		r.fileidset(g->used);
+	}
+}
+
+void
+Snapshot::write_id_metrics(SnapshotWriter &w)
+{
+	for (int i = 0; i < 2; i++) {
+		const IdMetricsSet &s = id_msum.rw[i];
+		write_idcount(w, s.once);
+		write_idcount(w, s.len);
+		write_idcount(w, s.maxlen);
+		write_idcount(w, s.minlen);
+		write_idcount(w, s.all);
+	}
+}
+
+void
+Snapshot::read_id_metrics(SnapshotReader &r)
+{
+	for (int i = 0; i < 2; i++) {
+		IdMetricsSet &s = id_msum.rw[i];
+		read_idcount(r, s.once);
+		read_idcount(r, s.len);
+		read_idcount(r, s.maxlen);
+		read_idcount(r, s.minlen);
+		read_idcount(r, s.all);
+	}
+}
+
+// The files the workspace was built from, and their hashes
+void
+Snapshot::write_sources(SnapshotWriter &w, Fileid input)
+{
+	w.str(input.get_path());
+	w.i32(max(Pdtoken::get_projects(), nprojects));
+	w.u32(Fileid::i2d.size());
+	for (FI_id_to_details::const_iterator i = Fileid::i2d.begin(); i != Fileid::i2d.end(); i++) {
+		w.str(i->name);
+		w.u32(i->hash.size());
+		w.bytes(i->hash.data(), i->hash.size());
+	}
+}
+
+void
+Snapshot::skip_sources(SnapshotReader &r)
+{
+	r.str();
+	nprojects = max(r.i32(), nprojects);
+	for (uint32_t n = r.u32(); n > 0; n--) {
+		r.str();
+		FileHash hash(r.u32());
+		r.bytes(hash.data(), hash.size());
+	}
+}
+
+// Return true if r starts with a header we can read
+bool
+Snapshot::read_header(SnapshotReader &r)
+{
+	char m[sizeof(magic)];
+	r.bytes(m, sizeof(m));
+	return memcmp(m, magic, sizeof(magic)) == 0 &&
+	    r.u32() == byte_order && r.u32() == version;
+}
+
+bool
+Snapshot::is_current(const string &fname, const string &input, int &projects)
+{
+	SnapshotReader r(fname);
+	if (!r.is_open())
+		return false;
+	if (!read_header(r)) {
+		cerr << fname << " is not a compatible workspace snapshot" << endl;
+		return false;
+	}
+	if (r.str() != get_full_path(input.c_str())) {
+		cerr << fname << " is a snapshot of a different workspace" << endl;
+		return false;
+	}
+	projects = r.i32();
+
+	int nchanged = 0;
+	for (uint32_t n = r.u32(); n > 0; n--) {
+		string name(r.str());
+		FileHash hash(r.u32());
+		r.bytes(hash.data(), hash.size());
+		// The anonymous file has no contents to check
+		if (hash.empty())
+			continue;
+		if (access(name.c_str(), R_OK) != 0) {
+			cerr << "Removed file " << name << endl;
+			nchanged++;
+		} else {
+			unsigned char *h = MD5File(name.c_str());
+			if (!equal(hash.begin(), hash.end(), h)) {
+				cerr << "Changed file " << name << endl;
+				nchanged++;
+			}
+		}
+	}
+	if (nchanged == 0)
+		return true;
+	cerr << fname << ": " << nchanged << " changed file(s)" << endl;
+	return false;
+}
+
+void
+Snapshot::save(const string &fname, Fileid input, bool partial)
+{
+	cerr << "Saving " << (partial ? "partial " : "") << "workspace to " << fname << endl;
+	SnapshotWriter w(fname);
+	w.bytes(magic, sizeof(magic));
+	w.u32(byte_order);
+	w.u32(version);
+	write_sources(w, input);
+	w.flag(partial);
+	write_projects(w);
+	write_files(w);
+	w.fileid(input);
+	write_ecs(w);
+	write_calls(w);
+	if (partial)
+		write_globs(w);
+	else
+		write_id_metrics(w);
+	w.close();
+}
+
+Fileid
+Snapshot::load(const string &fname)
+{
+	bool merge = (input_id != -1);
+	cerr << (merge ? "Merging" : "Loading") << " workspace from " << fname << endl;
+	SnapshotReader r(fname);
+	if (!r.is_open())
+		/*
+		 * @error
+		 * The file specified with the -L option could not be
+		 * opened
+		 */
+		Error::error(E_FATAL, "Unable to open workspace snapshot " + fname + ": " + strerror(errno), false);
+	if (!read_header(r))
+		/*
+		 * @error
+		 * The file specified with the -L option is not a
+		 * workspace snapshot, or it was written by a different
+		 * version of CScout or on a machine with a different
+		 * architecture.
+		 * Recreate it by processing the workspace with the -S option.
+		 */
+		Error::error(E_FATAL, fname + " is not a compatible workspace snapshot", false);
+	skip_sources(r);
+	bool is_part = r.flag();
+	if (merge && !(partial && is_part))
+		/*
+		 * @error
+		 * More than one workspace snapshot was specified
+		 * with the -L option, but not all of them are partial
+		 * workspaces created with the -w option
+		 */
+		Error::error(E_FATAL, "Only partial workspaces can be merged", false);
+	Fileid input;
+	if (merge) {
+		merge_projects(r);
+		merge_files(r);
+		input = r.fileid();
+		if (input.get_id() != input_id)
+			Error::error(E_FATAL, "Partial workspaces of different workspaces can not be merged", false);
+		merge_ecs(r);
+		merge_calls(r);
+		read_globs(r);
+	} else {
+		read_projects(r);
+		read_files(r);
+		input = r.fileid();
+		read_ecs(r);
+		read_calls(r);
+		if (is_part)
+			read_globs(r);
+		else
+			read_id_metrics(r);
+	}
+	if (!r.at_end())
+		/*
+		 * @error
+		 * The workspace snapshot contains data after its end
+		 */
+		Error::error(E_FATAL, "Corrupt workspace snapshot: trailing data", false);
+	partial = is_part;
+	input_id = input.get_id();
+	return input;
+}
@@ -0,0 +1,132 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * A binary snapshot of the analyzed workspace.
+ * It holds the state the web interface and the reports need after
+ * all files have been processed: projects, files with their metrics
+ * and include relationships, equivalence classes, identifiers,
+ * functions and macros with their call graph, and identifier metrics.
+ * Parsing state (symbol tables, macro definitions, global objects)
+ * is not saved, so a loaded workspace can not produce SQL output,
+ * tags, or obfuscated files.
+ *
+ * The format is specific to the CScout version and the machine that
+ * wrote it; a version number and a byte-order marker in the header
+ * guard against loading an incompatible file.
+ * The header is followed by the number of the workspace's projects and
+ * the MD5 hashes of all the files that were read, so that a snapshot can
+ * be checked against the current sources without loading it.
+ *
+ * A partial snapshot holds the state of a workspace shard after its
+ * files have been parsed, together with its global objects.
+ * Partial snapshots of the shards of a workspace are merged by
+ * matching their files by name and unifying the equivalence classes
+ * of identical Tokids; the result is then post-processed as if it had
+ * been parsed in a single run.
+ * Updating a workspace keeps a partial snapshot for each of its
+ * projects, so that only the projects whose files changed are parsed
+ * again.
+ *
+ * Include synopsis:
+ * #include <string>
+ * #include <vector>
+ *
+ * #include "fileid.h"
+ *
+ */
+
+#ifndef SNAPSHOT_
+#define SNAPSHOT_
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include "fileid.h"
+
+class Call;
+class Eclass;
+class Token;
+class Filedetails;
+class Metrics;
+class IdCount;
+class SnapshotWriter;
+class SnapshotReader;
+
+class Snapshot {
+private:
+	// Increase when the format changes
+	static const unsigned version = 6;
+	static bool partial;		// True if the loaded workspace is partial
+	static int input_id;		// Master file of the loaded workspace
+	static int nprojects;		// Projects of the loaded workspace
+
+	static void write_metrics(SnapshotWriter &w, const Metrics &m);
+	static void read_metrics(SnapshotReader &r, Metrics &m);
+	static void write_idcount(SnapshotWriter &w, const IdCount &c);
+	static void read_idcount(SnapshotReader &r, IdCount &c);
+	static void write_token(SnapshotWriter &w, const Token &t);
+	static Token read_token(SnapshotReader &r);
+	static void write_call(SnapshotWriter &w, const Call *c);
+	static Call *read_call(SnapshotReader &r);
+	static void read_call_graph(SnapshotReader &r, const vector <Call *> &calls);
+	static void read_details(SnapshotReader &r, Filedetails &d);
+	static void merge_details(Filedetails &a, const Filedetails &b);
+	static bool read_header(SnapshotReader &r);
+
+	static void write_sources(SnapshotWriter &w, Fileid input);
+	static void skip_sources(SnapshotReader &r);
+	static void write_projects(SnapshotWriter &w);
+	static void read_projects(SnapshotReader &r);
+	static void merge_projects(SnapshotReader &r);
+	static void write_files(SnapshotWriter &w);
+	static void read_files(SnapshotReader &r);
+	static void merge_files(SnapshotReader &r);
+	static void write_ecs(SnapshotWriter &w);
+	static void read_ecs(SnapshotReader &r);
+	static void merge_ecs(SnapshotReader &r);
+	static void add_member(Eclass *ec, Tokid t);
+	static Eclass *ec_at(Tokid t, int l);
+	static void merge_ec(int len, const vector <bool> &attr, const vector <Tokid> &members);
+	static void write_calls(SnapshotWriter &w);
+	static void read_calls(SnapshotReader &r);
+	static void merge_call(Call *e, const Call *c);
+	static void merge_calls(SnapshotReader &r);
+	static void write_globs(SnapshotWriter &w);
+	static void read_globs(SnapshotReader &r);
+	static void write_id_metrics(SnapshotWriter &w);
+	static void read_id_metrics(SnapshotReader &r);
+public:
+	// Save the workspace, whose master file is input, to fname
+	// A partial workspace is saved before it is post-processed
+	static void save(const string &fname, Fileid input, bool partial = false);
+	// Replace the workspace with the one saved in fname, or merge it
+	// into the partial workspace already loaded
+	// Return the workspace's master file
+	static Fileid load(const string &fname);
+	// Return true if the loaded workspace must still be post-processed
+	static bool is_partial() { return partial; }
+	// Return true if fname is a snapshot of the workspace input
+	// and none of the files it was built from has changed since
+	// Set projects to the number of the workspace's projects
+	static bool is_current(const string &fname, const string &input, int &projects);
+};
+
+#endif /* SNAPSHOT_ */
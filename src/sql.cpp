@@ -22,9 +22,20 @@
  */
 
 #include <cstring>
+#include <cerrno>
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef SQLITE
+#include <unistd.h>		// unlink
+#include <sqlite3.h>
+#endif
 
 #include "cpp.h"
+#include "error.h"
 #include "sql.h"
 
 // An instance of the database interface
@@ -62,6 +73,10 @@ Hsqldb::escape(char c)
 string
 Sql::escape(string s)
 {
+	// Most strings need no escaping
+	if (s.find_first_of(escaped_chars()) == string::npos)
+		return s;
+
 	string r;
 
 	for (string::const_iterator i = s.begin(); i != s.end(); i++)
@@ -72,16 +87,315 @@ Sql::escape(string s)
 bool
 Sql::setEngine(const char *dbengine)
 {
-	if (strcmp(dbengine, "mysql") == 0)
+	string name(dbengine), fmt;
+	string::size_type colon = name.find(':');
+	if (colon != string::npos) {
+		fmt = name.substr(colon + 1);
+		name.erase(colon);
+	}
+
+	if (name == "mysql")
 		instance = new Mysql();
-	else if (strcmp(dbengine, "hsqldb") == 0)
+	else if (name == "hsqldb")
 		instance = new Hsqldb();
-	else if (strcmp(dbengine, "postgres") == 0)
+	else if (name == "postgres")
 		instance = new Postgres();
+	else if (name == "sqlite") {
+		if (!fmt.empty() && fmt != "insert" && fmt != "batch" &&
+		    fmt != "copy" && fmt != "load") {
+			// The database file to write
+#ifdef SQLITE
+			instance = new SqliteDb(fmt);
+			return true;
+#else
+			cerr << "This version of CScout can not write SQLite databases\n";
+			return false;
+#endif
+		}
+		instance = new Sqlite();
+	} else {
+		cerr << "Unknown database engine " << name << "\n";
+		cerr << "Supported database engine types are: mysql postgres hsqldb sqlite\n";
+		return false;
+	}
+
+	if (fmt.empty() || fmt == "insert")
+		instance->format = f_insert;
+	else if (fmt == "batch")
+		instance->format = f_batch;
+	else if (fmt == "copy")
+		instance->format = f_copy;
+	else if (fmt == "load")
+		instance->format = f_load;
 	else {
-		cerr << "Unknown database engine " << dbengine << "\n";
-		cerr << "Supported database engine types are: mysql postgres hsqldb\n";
+		cerr << "Unknown database output format " << fmt << "\n";
+		cerr << "Supported output formats are: insert batch copy (postgres) load (mysql)\n";
+		return false;
+	}
+	if (!instance->supports(instance->format)) {
+		cerr << "The " << name << " database engine does not support the " << fmt << " output format\n";
 		return false;
 	}
 	return true;
 }
+
+Sql::~Sql()
+{
+	for (vector <Table *>::iterator i = tables.begin(); i != tables.end(); i++)
+		delete *i;
+}
+
+void
+Sql::begin_row(ostream &of, const char *table)
+{
+	out = &of;
+	first_field = true;
+	if (format == f_insert) {
+		of << "INSERT INTO " << table << " VALUES(";
+		row = &of;
+		return;
+	}
+
+	// Rows of the same table typically follow each other
+	if (current == NULL || current->name != table) {
+		current = NULL;
+		for (vector <Table *>::iterator i = tables.begin(); i != tables.end(); i++)
+			if ((*i)->name == table) {
+				current = *i;
+				break;
+			}
+		if (current == NULL) {
+			current = new Table(table);
+			tables.push_back(current);
+			if (format == f_load) {
+				string fname(current->name + ".tsv");
+				current->file.open(fname.c_str(), ios::out | ios::binary);
+				if (current->file.fail()) {
+					/*
+					 * @error
+					 * The tab-separated file for loading a table's
+					 * data into MySQL could not be created
+					 */
+					Error::error(E_FATAL, "Unable to open " + fname + " for writing: " + strerror(errno), false);
+				}
+			}
+		}
+	}
+
+	switch (format) {
+	case f_batch:
+		if (current->nrows)
+			current->rows << ",\n(";
+		else
+			current->rows << "INSERT INTO " << table << " VALUES(";
+		row = &current->rows;
+		break;
+	case f_copy:
+		row = &current->rows;
+		break;
+	case f_load:
+		row = &current->file;
+		break;
+	default:
+		csassert(0);
+	}
+}
+
+void
+Sql::field(bool v)
+{
+	separate();
+	*row << boolval(v);
+}
+
+void
+Sql::field(long long v)
+{
+	separate();
+	*row << v;
+}
+
+void
+Sql::field(double v)
+{
+	separate();
+	*row << v;
+}
+
+void
+Sql::end_row()
+{
+	switch (format) {
+	case f_insert:
+		*out << ");\n";
+		return;
+	case f_batch:
+		current->rows << ')';
+		break;
+	case f_copy:
+		current->rows << '\n';
+		break;
+	case f_load:
+		current->file << '\n';
+		return;
+	}
+	if (++current->nrows >= batch_rows || current->rows.tellp() >= batch_bytes)
+		flush_rows();
+}
+
+void
+Sql::flush_rows()
+{
+	for (vector <Table *>::iterator i = tables.begin(); i != tables.end(); i++) {
+		Table *t = *i;
+		if (t->nrows == 0)
+			continue;
+		if (format == f_copy)
+			*out << "COPY " << t->name << " FROM STDIN;\n" <<
+			    t->rows.str() << "\\.\n";
+		else
+			*out << t->rows.str() << ";\n";
+		t->rows.str("");
+		t->nrows = 0;
+	}
+}
+
+void
+Sql::flush(ostream &of)
+{
+	out = &of;
+	switch (format) {
+	case f_insert:
+		break;
+	case f_batch:
+	case f_copy:
+		flush_rows();
+		break;
+	case f_load:
+		for (vector <Table *>::iterator i = tables.begin(); i != tables.end(); i++) {
+			(*i)->file.close();
+			of << "LOAD DATA LOCAL INFILE '" << (*i)->name <<
+			    ".tsv' INTO TABLE " << (*i)->name << ";\n";
+		}
+		break;
+	}
+}
+
+void
+Sql::field(const string &s)
+{
+	ostream &of = *row;
+
+	separate();
+	if (format == f_insert || format == f_batch) {
+		of << '\'' << escape(s) << '\'';
+		return;
+	}
+	// The text format of PostgreSQL COPY and of MySQL LOAD DATA
+	for (string::const_iterator i = s.begin(); i != s.end(); i++)
+		switch (*i) {
+		case '\\': of << "\\\\"; break;
+		case '\n': of << "\\n"; break;
+		case '\r': of << "\\r"; break;
+		case '\t': of << "\\t"; break;
+		default: of << *i; break;
+		}
+}
+
+#ifdef SQLITE
+SqliteDb::SqliteDb(const string &fname) : db(NULL), insert(NULL), column(0)
+{
+	// The tables are created anew
+	unlink(fname.c_str());
+	check(sqlite3_open(fname.c_str(), &db));
+	// A failed load can simply be repeated
+	check(sqlite3_exec(db, "PRAGMA synchronous = OFF; PRAGMA journal_mode = OFF;", NULL, NULL, NULL));
+}
+
+SqliteDb::~SqliteDb()
+{
+	for (vector <pair <string, sqlite3_stmt *> >::iterator i = inserts.begin(); i != inserts.end(); i++)
+		sqlite3_finalize(i->second);
+	sqlite3_close(db);
+}
+
+void
+SqliteDb::check(int rc)
+{
+	if (rc == SQLITE_OK || rc == SQLITE_DONE || rc == SQLITE_ROW)
+		return;
+	/*
+	 * @error
+	 * An error occurred while writing to the SQLite database
+	 * specified with the -s option
+	 */
+	Error::error(E_FATAL, string("SQLite database error: ") + (db ? sqlite3_errmsg(db) : sqlite3_errstr(rc)), false);
+}
+
+void
+SqliteDb::execute(ostream &of, const string &s)
+{
+	check(sqlite3_exec(db, s.c_str(), NULL, NULL, NULL));
+}
+
+sqlite3_stmt *
+SqliteDb::prepare(const char *table)
+{
+	for (vector <pair <string, sqlite3_stmt *> >::iterator i = inserts.begin(); i != inserts.end(); i++)
+		if (i->first == table)
+			return i->second;
+
+	// Obtain the number of the table's columns
+	sqlite3_stmt *stmt;
+	string sql(string("SELECT * FROM ") + table);
+	check(sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, NULL));
+	int ncol = sqlite3_column_count(stmt);
+	sqlite3_finalize(stmt);
+
+	sql = string("INSERT INTO ") + table + " VALUES(";
+	for (int i = 0; i < ncol; i++)
+		sql += i ? ",?" : "?";
+	sql += ')';
+	check(sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, NULL));
+	inserts.push_back(pair <string, sqlite3_stmt *>(table, stmt));
+	return stmt;
+}
+
+void
+SqliteDb::begin_row(ostream &of, const char *table)
+{
+	insert = prepare(table);
+	column = 1;
+}
+
+void
+SqliteDb::field(bool v)
+{
+	check(sqlite3_bind_int(insert, column++, v));
+}
+
+void
+SqliteDb::field(long long v)
+{
+	check(sqlite3_bind_int64(insert, column++, v));
+}
+
+void
+SqliteDb::field(double v)
+{
+	check(sqlite3_bind_double(insert, column++, v));
+}
+
+void
+SqliteDb::field(const string &s)
+{
+	check(sqlite3_bind_text(insert, column++, s.data(), s.length(), SQLITE_TRANSIENT));
+}
+
+void
+SqliteDb::end_row()
+{
+	check(sqlite3_step(insert));
+	check(sqlite3_reset(insert));
+}
+#endif
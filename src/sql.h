@@ -19,25 +19,110 @@
  *
  * Portable SQL database abstraction
  *
+ * Table rows are written through SqlRow objects, so that each engine
+ * can output them in the format that loads fastest: an INSERT statement
+ * per row, multi-row INSERT statements, or the engine's bulk loading
+ * format.  Except for the first, the formats collect the rows of each
+ * table and write them out in batches.  All batches are written
+ * together, in the order their tables were first used, so that the
+ * rows a foreign key refers to are loaded before it.
+ *
+ * When compiled with SQLITE defined, the sqlite engine can also write
+ * the data directly into an SQLite database file, through prepared
+ * statements.
+ *
+ * Include synopsis:
+ * #include <fstream>
+ * #include <sstream>
+ * #include <string>
+ * #include <vector>
+ *
  */
 
 
 #ifndef SQL_
 #define SQL_
 
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
 class Sql {
+public:
+	// How table rows are output
+	enum e_format {
+		f_insert,	// An INSERT statement for each row
+		f_batch,	// INSERT statements for many rows
+		f_copy,		// PostgreSQL COPY FROM STDIN blocks
+		f_load,		// Tab-separated files read with MySQL LOAD DATA
+	};
+private:
 	// Instance of current engine
 	static Sql *instance;
+
+	// The rows collected for a table
+	struct Table {
+		string name;		// Table name
+		ostringstream rows;	// Rows of f_batch and f_copy
+		ofstream file;		// Rows of f_load
+		int nrows;		// Rows collected
+		Table(const string &n) : name(n), nrows(0) {}
+	};
+	// Rows and bytes after which collected rows are written out
+	static const int batch_rows = 1000;
+	static const int batch_bytes = 1024 * 1024;
+	e_format format;		// Selected output format
+	vector <Table *> tables;	// In the order they were first used
+	Table *current;			// Table of the current row
+	ostream *out;			// Stream of the current row's statements
+	ostream *row;			// Stream of the current row's fields
+	bool first_field;		// True before the row's first field
+
+	// Write out the rows collected in f_batch and f_copy
+	void flush_rows();
+	// Output the separator before a row's field
+	void separate() {
+		if (first_field)
+			first_field = false;
+		else
+			*row << (format == f_insert || format == f_batch ? ',' : '\t');
+	}
+protected:
+	Sql() : format(f_insert), current(NULL), out(NULL), row(NULL) {}
+	// Return true if the engine can output rows in format f
+	virtual bool supports(e_format f) { return f == f_insert || f == f_batch; }
 public:
-	virtual ~Sql() {}
+	virtual ~Sql();
 	// Set the database to the specified engine
+	// An engine-specific output format can follow the name after a colon
 	// Return true if OK
 	static bool setEngine(const char *dbengine);
 	static Sql *getInterface() { return instance; }
 	virtual const char * begin_commands() { return ""; };
 	virtual const char * end_commands() { return ""; };
+	// Return true if the indexes of workdb_indexes should be created
+	virtual bool create_indexes() { return false; }
+	// Execute the SQL statements s, writing them to of
+	virtual void execute(ostream &of, const string &s) { of << s; }
+	// Start a row of table, to be written to of
+	virtual void begin_row(ostream &of, const char *table);
+	// Add to the row a field with the specified value
+	virtual void field(bool v);
+	virtual void field(long long v);
+	virtual void field(double v);
+	virtual void field(const string &s);
+	// End the row started with begin_row
+	virtual void end_row();
+	// Write to of all rows collected so far
+	// Must be called before the end_commands
+	virtual void flush(ostream &of);
 	virtual string escape(string s);
 	virtual const char * escape(char c);
+	// Return the characters escape(char) changes
+	virtual const char *escaped_chars() { return "'"; }
 	virtual const char *ptrtype() {
 		return sizeof(void *) > 4 ? "BIGINT" : "INTEGER";
 	}
@@ -47,6 +132,8 @@ public:
 };
 
 class Mysql: public Sql {
+protected:
+	bool supports(e_format f) { return f == f_load || Sql::supports(f); }
 public:
 	const char * begin_commands() {
 		return "SET SESSION sql_mode=NO_BACKSLASH_ESCAPES;\n";
@@ -60,10 +147,79 @@ class Hsqldb: public Sql {
 public:
 	const char *varchar() { return "LONGVARCHAR"; }
 	const char * escape(char c);
+	const char *escaped_chars() { return "'\n\r"; }
 };
 
 class Postgres: public Sql {
+protected:
+	bool supports(e_format f) { return f == f_copy || Sql::supports(f); }
+};
+
+class Sqlite: public Sql {
+public:
+	// Large transactions make SQLite load the data much faster
+	const char * begin_commands() { return "BEGIN TRANSACTION;\n"; };
+	const char * end_commands() { return "COMMIT;\n"; };
+	bool create_indexes() { return true; }
+	const char *varchar() { return "TEXT"; }
+	const char *boolval(bool v);
+};
+
+#ifdef SQLITE
+struct sqlite3;
+struct sqlite3_stmt;
+
+// Rows inserted directly into an SQLite database
+class SqliteDb: public Sqlite {
+private:
+	sqlite3 *db;
+	// Prepared INSERT statement of each table
+	vector <pair <string, sqlite3_stmt *> > inserts;
+	sqlite3_stmt *insert;		// Statement of the current row
+	int column;			// Parameter of the next field
+
+	// Terminate the program if rc is an SQLite error
+	void check(int rc);
+	// Return the INSERT statement of table
+	sqlite3_stmt *prepare(const char *table);
+public:
+	// Create the database file fname
+	SqliteDb(const string &fname);
+	~SqliteDb();
+	void execute(ostream &of, const string &s);
+	void begin_row(ostream &of, const char *table);
+	void field(bool v);
+	void field(long long v);
+	void field(double v);
+	void field(const string &s);
+	void end_row();
+	void flush(ostream &of) {}
+};
+#endif
+
+/*
+ * A table row written through the database interface.
+ * Its fields are appended with <<, and it ends when the object
+ * is destroyed.  It is used as a temporary, as in
+ * SqlRow(db, of, "TOKENS") << fid.get_id() << offset << eid;
+ */
+class SqlRow {
+private:
+	Sql *db;
 public:
+	SqlRow(Sql *d, ostream &of, const char *table) : db(d) {
+		db->begin_row(of, table);
+	}
+	~SqlRow() { db->end_row(); }
+	SqlRow &operator <<(bool v) { db->field(v); return *this; }
+	SqlRow &operator <<(double v) { db->field(v); return *this; }
+	SqlRow &operator <<(const string &s) { db->field(s); return *this; }
+	SqlRow &operator <<(const char *s) { db->field(string(s)); return *this; }
+	// Integral values
+	template <class T> SqlRow &operator <<(T v) {
+		db->field((long long)v);
+		return *this;
+	}
 };
 
 
@@ -80,4 +236,10 @@ Mysql::boolval(bool v)
 	return v ? "1" : "0";
 }
 
+inline const char *
+Sqlite::boolval(bool v)
+{
+	return v ? "1" : "0";
+}
+
 #endif // SQL_
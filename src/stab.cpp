@@ -264,7 +264,7 @@ obj_define(const Token& tok, Type typ)
 				fc = new FCall(utok, typ, tok.get_name());
 			}
 		}
-		fc->metrics().set_metric(FunMetrics::em_nparam, typ.get_nparam());
+		fc->set_nparam(typ.get_nparam());
 	}
 
 	static Stab Block::*objptr = &Block::obj;
@@ -46,7 +46,7 @@
 stackTchar Tchar::ps;			// Putback Tchars (from putback())
 dequePtoken Tchar::iq;		// Input queue
 dequePtoken::const_iterator Tchar::qi;
-dequeTpart::const_iterator Tchar::pi;
+vectorTpart::const_iterator Tchar::pi;
 int Tchar::part_idx;
 string::size_type Tchar::val_idx;
 
@@ -53,7 +53,7 @@ private:
 	// Token from iq use for getnext
 	static dequePtoken::const_iterator qi;
 	// Token part from *qi to use for getnext
-	static dequeTpart::const_iterator pi;
+	static vectorTpart::const_iterator pi;
 	// Index to character of token part to use for getnext
 	static int part_idx;
 	// Index to character from token val to use for getnext
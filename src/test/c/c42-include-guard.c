@@ -0,0 +1,9 @@
+/* Headers with an include guard */
+#ifdef PRJ2
+#define GUARD_H
+#endif
+
+#include "guard.h"
+#include "guard.h"
+
+int guarded;
@@ -0,0 +1,6 @@
+#ifndef GUARD_H
+#define GUARD_H
+
+extern int guarded;
+
+#endif /* GUARD_H */
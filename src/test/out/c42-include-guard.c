@@ -0,0 +1,187 @@
+Table: Ids
+ EID  NAME            READONLY  UNDEFMACRO  MACRO  MACROARG  ORDINARY  SUETAG  SUMEMBER  LABEL  TYPEDEF  ENUM   YACC   FUN    CSCOPE  LSCOPE  UNUSED
+----  --------------  --------  ----------  -----  --------  --------  ------  --------  -----  -------  -----  -----  -----  ------  ------  ------
+ 107  GUARD_H         FALSE     TRUE        TRUE   FALSE     FALSE     FALSE   FALSE     FALSE  FALSE    FALSE  FALSE  FALSE  FALSE   FALSE   FALSE
+ 109  MAXDIGIT        FALSE     FALSE       TRUE   FALSE     FALSE     FALSE   FALSE     FALSE  FALSE    FALSE  FALSE  FALSE  FALSE   FALSE   TRUE
+ 397  x               FALSE     FALSE       FALSE  FALSE     TRUE      FALSE   FALSE     FALSE  FALSE    FALSE  FALSE  FALSE  FALSE   TRUE    TRUE
+ 529  main            TRUE      FALSE       FALSE  FALSE     TRUE      FALSE   FALSE     FALSE  FALSE    FALSE  FALSE  TRUE   FALSE   TRUE    FALSE
+ 539  guarded         FALSE     FALSE       FALSE  FALSE     TRUE      FALSE   FALSE     FALSE  FALSE    FALSE  FALSE  FALSE  FALSE   TRUE    FALSE
+ 685  qqq             FALSE     FALSE       FALSE  FALSE     TRUE      FALSE   FALSE     FALSE  FALSE    FALSE  FALSE  FALSE  FALSE   TRUE    TRUE
+1069  foo             FALSE     FALSE       FALSE  FALSE     TRUE      FALSE   FALSE     FALSE  FALSE    FALSE  FALSE  TRUE   FALSE   TRUE    TRUE
+3569  __DATE__        TRUE      FALSE       TRUE   FALSE     FALSE     FALSE   FALSE     FALSE  FALSE    FALSE  FALSE  FALSE  FALSE   FALSE   TRUE
+3953  __TIME__        TRUE      FALSE       TRUE   FALSE     FALSE     FALSE   FALSE     FALSE  FALSE    FALSE  FALSE  FALSE  FALSE   FALSE   TRUE
+4289  __FILE__        TRUE      FALSE       TRUE   FALSE     FALSE     FALSE   FALSE     FALSE  FALSE    FALSE  FALSE  FALSE  FALSE   FALSE   TRUE
+4637  __LINE__        TRUE      FALSE       TRUE   FALSE     FALSE     FALSE   FALSE     FALSE  FALSE    FALSE  FALSE  FALSE  FALSE   FALSE   TRUE
+4865  __STDC__        TRUE      FALSE       TRUE   FALSE     FALSE     FALSE   FALSE     FALSE  FALSE    FALSE  FALSE  FALSE  FALSE   FALSE   TRUE
+6425  _cscout_dummy1  TRUE      FALSE       FALSE  FALSE     TRUE      FALSE   FALSE     FALSE  FALSE    FALSE  FALSE  TRUE   TRUE    FALSE   FALSE
+Table: Tokens
+FID  FOFFSET   EID
+---  -------  ----
+  2      297  3569
+  2      329  3953
+  2      357  4289
+  2      386  4637
+  2      405  4865
+  2      471   529
+  2      535  6425
+  2      558  6425
+  4       43   525
+  4       56   107
+  4      115   539
+  5        8   107
+  5       24   107
+  5       44   539
+  6        8   109
+  6       32   397
+  6       43   529
+  6       56   685
+  6       88  1069
+Table: Rest
+FID  FOFFSET  CODE
+---  -------  --------------------------------------------------------------------
+  2      287  \u0000a\u0000a#define
+  2      305
+  2      320  \u0000a#define
+  2      337
+  2      348  \u0000a#define
+  2      365
+  2      377  \u0000a#define
+  2      394   1\u0000a#define
+  2      413   1\u0000a\u0000a
+  2      466  \u0000aint
+  2      475  ();\u0000a
+  2      522  \u0000astatic void
+  2      549  (void) {
+  2      572  (); }\u0000a
+  3      152  \u0000a\u0000a\u0000a#pragma includepath
+  3      195  \u0000a
+  3      239  \u0000astatic void _cscout_dummy2(void) { _cscout_dummy2(); }\u0000a
+  4       35  \u0000a#ifdef
+  4       47  \u0000a#define
+  4       63  \u0000a#endif\u0000a\u0000a#include
+  4       90  \u0000a#include
+  4      109  \u0000a\u0000aint
+  4      122  ;\u0000a
+  5        0  #ifndef
+  5       15  \u0000a#define
+  5       31  \u0000a\u0000aextern int
+  5       51  ;\u0000a\u0000a#endif
+  5       74  \u0000a
+  6        0  #define
+  6       16   11\u0000d\u0000aextern int
+  6       33  ;\u0000d\u0000aextern
+  6       47  ();\u0000d\u0000aint
+  6       59  ;\u0000d\u0000a\u0000d\u0000a
+  6       86  \u0000d\u0000a
+  6       91  () {\u0000d\u0000a
+  6      116  }\u0000d\u0000a\u0000d\u0000a
+Table: Projects
+PID  NAME
+---  -----------
+ 16  unspecified
+ 17  Prj1
+ 18  Prj2
+Table: IdProj
+ EID  PID
+----  ---
+ 107   17
+ 529   17
+ 539   17
+3569   17
+3953   17
+4289   17
+4637   17
+4865   17
+6425   17
+ 107   18
+ 109   18
+ 397   18
+ 529   18
+ 539   18
+ 685   18
+1069   18
+3569   18
+3953   18
+4289   18
+4637   18
+4865   18
+6425   18
+Table: Files
+FID  NAME                 RO     NCHAR  NCCOMMENT  NSPACE  NLCOMMENT  NBCOMMENT  NLINE  MAXLINELEN  NSTRING  NULINE  NPPDIRECTIVE  NPPCOND  NPPFMACRO  NPPOMACRO  NPPTOKEN  NCTOKEN  NCOPIES  NSTATEMENT  NPFUNCTION  NFFUNCTION  NPVAR  NFVAR  NAGGREGATE  NAMEMBER  NENUM  NEMEMBER  NINCFILE
+---  -------------------  -----  -----  ---------  ------  ---------  ---------  -----  ----------  -------  ------  ------------  -------  ---------  ---------  --------  -------  -------  ----------  ----------  ----------  -----  -----  ----------  --------  -----  --------  --------
+  2  host-defs.h          TRUE     578        367      29          0          3     22          61        3       0             5        0          0          5        37       18        1           1           0           1      0      0           0         0      0         0         0
+  3  host-incs.h          TRUE     295        187      13          0          2     13          54        1       0             1        0          0          0        16        0        1           0           0           0      0      0           0         0      0         0         0
+  4  c42-include-guard.c  FALSE    124         31      14          0          1      9          35        2       0             5        1          0          0        17        4        1           0           0           0      1      0           0         0      0         0         2
+  5  guard.h              FALSE     75          9      11          0          1      6          20        0       0             3        1          0          1        12        4        1           0           0           0      1      0           0         0      0         0         0
+  6  prj2.c               FALSE    121         34      26          2          0     11          21        0       0             1        0          0          1        21       18        1           0           1           0      2      0           0         0      0         0         0
+Table: FileProj
+FID  PID
+---  ---
+  2   17
+  3   17
+  4   17
+  5   17
+  1   18
+  2   18
+  3   18
+  4   18
+  5   18
+  6   18
+Table: Definers
+PID  CUID  BASEFILEID  DEFINERID
+---  ----  ----------  ---------
+ 17     4           4          5
+ 18     4           4          1
+ 18     4           5          4
+ 18     6           6          2
+Table: Includers
+PID  CUID  BASEFILEID  INCLUDERID
+---  ----  ----------  ----------
+ 17     2           2           1
+ 17     4           3           1
+ 17     4           4           1
+ 17     4           5           4
+ 18     2           2           1
+ 18     2           2           1
+ 18     4           3           1
+ 18     4           4           1
+ 18     4           5           4
+ 18     6           3           1
+ 18     6           6           1
+Table: Providers
+PID  CUID  PROVIDERID
+---  ----  ----------
+ 17     2           2
+ 17     4           4
+ 18     2           2
+ 18     2           2
+ 18     4           4
+ 18     6           6
+Table: IncTriggers
+PID  CUID  BASEFILEID  DEFINERID  FOFFSET  LEN
+---  ----  ----------  ---------  -------  ---
+ 17     4           4          5       44    7
+ 18     4           5          4       56    7
+ 18     6           6          2      471    4
+Table: Functions
+  ID  NAME            ISMACRO  DEFINED  DECLARED  FILESCOPED  FID  FOFFSET  FANIN
+----  --------------  -------  -------  --------  ----------  ---  -------  -----
+1069  foo             FALSE    TRUE     TRUE      FALSE         6       88      0
+5657  main            FALSE    FALSE    TRUE      FALSE         2      471      0
+6425  _cscout_dummy1  FALSE    TRUE     TRUE      TRUE          2      535      1
+Table: FunctionMetrics
+FUNCTIONID  NCHAR  NCCOMMENT  NSPACE  NLCOMMENT  NBCOMMENT  NLINE  MAXLINELEN  NSTRING  NULINE  NPPDIRECTIVE  NPPCOND  NPPFMACRO  NPPOMACRO  NPPTOKEN  NCTOKEN  NSTMT  NOP  NUOP  NNCONST  NCLIT  NIF  NELSE  NSWITCH  NCASE  NDEFAULT  NBREAK  NFOR  NWHILE  NDO  NCONTINUE  NGOTO  NRETURN  NPID  NFID  NMID  NID  NUPID  NUFID  NUMID  NUID  NGNSOC  NPARAM  MAXNEST  NLABEL  FANIN  FANOUT  CCYCL1  CCYCL2  CCYCL3  CSTRUC   CHAL  IFLOW  FIDBEGIN  FOFFSETBEGIN  FIDEND  FOFFSETEND
+----------  -----  ---------  ------  ---------  ---------  -----  ----------  -------  ------  ------------  -------  ---------  ---------  --------  -------  -----  ---  ----  -------  -----  ---  -----  -------  -----  --------  ------  ----  ------  ---  ---------  -----  -------  ----  ----  ----  ---  -----  -----  -----  ----  ------  ------  -------  ------  -----  ------  ------  ------  ------  ------  -----  -----  --------  ------------  ------  ----------
+      1069     23         15       4          1          0      2          18        0       0             0        0          0          0         1        1      0    0     0        0      0    0      0        0      0         0       0     0       0    0          0      0        0     0     0     0    0      0      0      0     0      17       0        0       0      0       0       1       1       1   0.0E0  0.0E0  0.0E0         6            95       6         117
+      6425     21          0       3          0          0      1          20        0       0             0        0          0          0         5        5      1    0     0        0      0    0      0        0      0         0       0     0       0    0          0      0        0     0     1     0    1      0      1      0     1       9       0        0       0      1       1       1       1       1   1.0E0  0.0E0  1.0E0         2           557       2         577
+Table: FunctionId
+FUNCTIONID  ORDINAL   EID
+----------  -------  ----
+      1069        0  1069
+      5657        0   529
+      6425        0  6425
+Table: Fcalls
+SOURCEID  DESTID
+--------  ------
+    6425    6425
+Done
@@ -96,20 +96,20 @@ Token::unique() const
 {
 	Token r(code);
 	r.val = val;
-	dequeTpart::const_iterator i;
+	vectorTpart::const_iterator i;
 	for (i = parts.begin(); i != parts.end(); i++)
 		r.parts.push_back(Tpart(i->get_tokid().unique(), i->get_len()));
 	return (r);
 }
 
-dequeTpart
+vectorTpart
 Token::constituents() const
 {
-	dequeTpart r;
-	dequeTpart::const_iterator i;
+	vectorTpart r;
+	vectorTpart::const_iterator i;
 	for (i = parts.begin(); i != parts.end(); i++) {
 		if (DP()) cout << "Constituents of " << *i << "\n";
-		dequeTpart c = (*i).get_tokid().constituents((*i).get_len());
+		vectorTpart c = (*i).get_tokid().constituents((*i).get_len());
 		copy(c.begin(), c.end(), back_inserter(r));
 	}
 	return (r);
@@ -121,7 +121,7 @@ Token::get_refactored_name() const
 	if (parts.begin() == parts.end())
 		return val;
 	string result;
-	for (dequeTpart::const_iterator i = parts.begin(); i != parts.end(); i++) {
+	for (vectorTpart::const_iterator i = parts.begin(); i != parts.end(); i++) {
 		Eclass *ec = i->get_tokid().check_ec();
 		if (ec == NULL)
 			return val;
@@ -142,7 +142,7 @@ Token::get_refactored_name() const
 void
 Token::set_ec_attribute(enum e_attribute a) const
 {
-	dequeTpart::const_iterator i;
+	vectorTpart::const_iterator i;
 	for (i = parts.begin(); i != parts.end(); i++)
 		i->get_tokid().set_ec_attribute(a, i->get_len());
 }
@@ -150,7 +150,7 @@ Token::set_ec_attribute(enum e_attribute a) const
 bool
 Token::has_ec_attribute(enum e_attribute a) const
 {
-	dequeTpart::const_iterator i;
+	vectorTpart::const_iterator i;
 	for (i = parts.begin(); i != parts.end(); i++)
 		if (i->get_tokid().has_ec_attribute(a, i->get_len()))
 			return true;
@@ -160,7 +160,7 @@ Token::has_ec_attribute(enum e_attribute a) const
 bool
 Token::contains(Eclass *ec) const
 {
-	dequeTpart::const_iterator i;
+	vectorTpart::const_iterator i;
 	for (i = parts.begin(); i != parts.end(); i++)
 		if ((*i).get_tokid().get_ec() == ec)
 			return (true);
@@ -174,10 +174,10 @@ Token::contains(Eclass *ec) const
  * The operation only modifies the underlying equivalence classes
  */
 void
-Tpart::homogenize(const dequeTpart &a, const dequeTpart &b)
+Tpart::homogenize(const vectorTpart &a, const vectorTpart &b)
 {
-	dequeTpart::const_iterator ai = a.begin();
-	dequeTpart::const_iterator bi = b.begin();
+	vectorTpart::const_iterator ai = a.begin();
+	vectorTpart::const_iterator bi = b.begin();
 	Eclass *ae = (*ai).get_tokid().get_ec();
 	Eclass *be = (*bi).get_tokid().get_ec();
 	int alen, blen;
@@ -216,8 +216,8 @@ Token::unify(const Token &a /* definition */, const Token &b /* reference */)
 {
 	if (DP()) cout << "Unify " << a << " and " << b << "\n";
 	// Get the constituent Tokids; they may have grown more than the parts
-	dequeTpart ac = a.constituents();
-	dequeTpart bc = b.constituents();
+	vectorTpart ac = a.constituents();
+	vectorTpart bc = b.constituents();
 	// Make the constituents of same length
 	if (DP()) cout << "Before homogenization: " << "\n" << "a=" << a << "\n" << "b=" << b << "\n";
 	Tpart::homogenize(ac, bc);
@@ -226,7 +226,7 @@ Token::unify(const Token &a /* definition */, const Token &b /* reference */)
 	bc = b.constituents();
 	if (DP()) cout << "After homogenization: " << "\n" << "a=" << ac << "\n" << "b=" << bc << "\n";
 	// Now merge the corresponding ECs
-	dequeTpart::const_iterator ai, bi;
+	vectorTpart::const_iterator ai, bi;
 	for (ai = ac.begin(), bi = bc.begin(); ai != ac.end(); ai++, bi++) {
 		if (check_clashes) {
 			if (ai->get_tokid().get_ec() != bi->get_tokid().get_ec()) {
@@ -244,9 +244,9 @@ Token::unify(const Token &a /* definition */, const Token &b /* reference */)
 }
 
 ostream&
-operator<<(ostream& o,const dequeTpart& dt)
+operator<<(ostream& o,const vectorTpart& dt)
 {
-	dequeTpart::const_iterator i;
+	vectorTpart::const_iterator i;
 
 	for (i = dt.begin(); i != dt.end(); i++) {
 		o << *i;
@@ -264,9 +264,9 @@ operator<<(ostream& o,const dequeTpart& dt)
 bool
 Token::equals(const Token &stale) const
 {
-	dequeTpart freshp(this->constituents());
-	dequeTpart stalep(stale.get_parts_begin(), stale.get_parts_end());
-	dequeTpart::const_iterator fi, si;
+	vectorTpart freshp(this->constituents());
+	vectorTpart stalep(stale.get_parts_begin(), stale.get_parts_end());
+	vectorTpart::const_iterator fi, si;
 	Tokid fid, sid;
 	int flen, slen;
 
@@ -323,7 +323,7 @@ Token::get_defining_tokid() const
 	bool have_best = false;
 	int best_distance = numeric_limits<int>::max();
 	int d;
-	for (dequeTpart::const_iterator i = parts.begin(); i != parts.end(); i++)
+	for (vectorTpart::const_iterator i = parts.begin(); i != parts.end(); i++)
 		if (i->get_tokid().get_fileid() == current.get_fileid() &&
 		    (d = labs(i->get_tokid().get_streampos() - current.get_streampos())) < best_distance) {
 		    	best_distance = d;
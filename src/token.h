@@ -41,7 +41,7 @@ private:
 public:
 	Tpart() {};
 	Tpart(Tokid t, int l): ti(t), len(l) {};
-	static void homogenize(const dequeTpart &a, const dequeTpart &b);
+	static void homogenize(const vectorTpart &a, const vectorTpart &b);
 	Tokid get_tokid() const { return ti; }
 	int get_len() const { return len; }
 	friend ostream& operator<<(ostream& o, const Tpart &t);
@@ -50,14 +50,14 @@ public:
 	inline friend bool operator <(const class Tpart &a, const class Tpart &b);
 };
 
-typedef deque<Tpart> dequeTpart;
-// Print dequeTpart sequences
-ostream& operator<<(ostream& o,const dequeTpart& dt);
+// Print vectorTpart sequences
+ostream& operator<<(ostream& o,const vectorTpart& dt);
 
 class Token {
+	friend class Snapshot;
 protected:
 	int code;			// Token type code
-	dequeTpart parts;		// Identifiers for constituent parts
+	vectorTpart parts;		// Identifiers for constituent parts
 	string val;			// Token character contents (for identifiers)
 public:
 	// Modify class's operation to check for name clashes of refactored ids
@@ -74,7 +74,7 @@ public:
 	Token(int icode, const string& v)
 		: code(icode), val(v)
 	{
-		parts.push_front(Tpart(Tokid(0, 0), v.length()));
+		parts.push_back(Tpart(Tokid(0, 0), v.length()));
 	}
 	Token() {};
 	// Accessor method
@@ -89,7 +89,7 @@ public:
 	// Return the token's symbolic name based on its code
 	string name() const;
 	// Return the constituent Tokids; they may be more than the parts
-	dequeTpart constituents() const;
+	vectorTpart constituents() const;
 	// Return a token that uniquely represents all same tokens coming from identical files
 	Token unique() const;
 	// Return the Tokid best defining this token wrt the current file position
@@ -97,9 +97,9 @@ public:
 	// Send it on ostream
 	friend ostream& operator<<(ostream& o,const Token &t);
 	// Iterators for accessing the token parts
-	inline dequeTpart::const_iterator get_parts_begin() const;
-	inline dequeTpart::const_iterator get_parts_end() const;
-	inline dequeTpart::size_type get_parts_size() const {
+	inline vectorTpart::const_iterator get_parts_begin() const;
+	inline vectorTpart::const_iterator get_parts_end() const;
+	inline vectorTpart::size_type get_parts_size() const {
 		return parts.size();
 	}
 	/*
@@ -123,13 +123,13 @@ public:
 	inline friend bool operator <(const class Token &a, const class Token &b);
 };
 
-dequeTpart::const_iterator
+vectorTpart::const_iterator
 Token::get_parts_begin() const
 {
 	return parts.begin();
 }
 
-dequeTpart::const_iterator
+vectorTpart::const_iterator
 Token::get_parts_end() const
 {
 	return parts.end();
@@ -157,7 +157,7 @@ operator ==(const class Token &a, const class Token &b)
 {
 	if (a.parts.size() != b.parts.size())
 		return (false);
-	dequeTpart::const_iterator ia, ib;
+	vectorTpart::const_iterator ia, ib;
 	for (ia = a.parts.begin(), ib = b.parts.begin(); ia != a.parts.end(); ia++, ib++)
 		if (*ia != *ib)
 			return (false);
@@ -48,9 +48,8 @@
 #include "eclass.h"
 
 
-mapTokidEclass Tokid::tm;		// Map from tokens to their equivalence
-
-mapTokidEclass tokid_map;		// Dummy; used for printing
+TokidMap tokid_map;		// Dummy; used for printing
+size_t Tokid::nmapped;		// Tokids mapped to equivalence classes
 
 ostream&
 operator<<(ostream& o,const Tokid t)
@@ -60,17 +59,16 @@ operator<<(ostream& o,const Tokid t)
 }
 
 ostream&
-operator<<(ostream& o,const mapTokidEclass& t)
+operator<<(ostream& o,const TokidMap& t)
 {
-	mapTokidEclass::const_iterator i;
-
-	for (i = Tokid::tm.begin(); i != Tokid::tm.end(); i++) {
-		// Convert Tokids into Tparts to also display their content
-		Tokid t = (*i).first;
-		Eclass e = *((*i).second);
-		Tpart p(t, e.get_len());
-		o << p << ":\n";
-		o << e << "\n\n";
+	for (int i = 0; i <= Fileid::max_id(); i++) {
+		Fileid fi(i);
+		fi.get_ec_index().for_each([&o, fi](cs_offset_t offs, Eclass *ec) {
+			// Convert Tokids into Tparts to also display their content
+			Tpart p(Tokid(fi, offs), ec->get_len());
+			o << p << ":\n";
+			o << *ec << "\n\n";
+		});
 	}
 	return o;
 }
@@ -79,13 +77,14 @@ operator<<(ostream& o,const mapTokidEclass& t)
 void
 Tokid::clear()
 {
-	mapTokidEclass::const_iterator i;
 	set <Eclass *> es;
 
-	if (DP()) cout << "Have " << Tokid::tm.size() << " tokids\n";
+	if (DP()) cout << "Have " << Tokid::map_size() << " tokids\n";
 	// First create a set of all ecs
-	for (i = Tokid::tm.begin(); i != Tokid::tm.end(); i++)
-		es.insert((*i).second);
+	for (int i = 0; i <= Fileid::max_id(); i++)
+		Fileid(i).get_ec_index().for_each([&es](cs_offset_t offs, Eclass *ec) {
+			es.insert(ec);
+		});
 	// Then free them
 	if (DP()) cout << "Deleting " << es.size() << " classes\n";
 	set <Eclass *>::const_iterator si;
@@ -94,17 +93,19 @@ Tokid::clear()
 		delete (*si);
 	}
 	// Finally, clear the map
-	tm.clear();
+	for (int i = 0; i <= Fileid::max_id(); i++)
+		Fileid(i).get_ec_index().clear();
+	nmapped = 0;
 }
 
-dequeTpart
+vectorTpart
 Tokid::constituents(int l)
 {
 	Tokid t = *this;
-	dequeTpart r;
-	mapTokidEclass::const_iterator e = tm.find(t);
+	vectorTpart r;
+	Eclass *e = t.check_ec();
 
-	if (e == Tokid::tm.end()) {
+	if (e == NULL) {
 		// No EC defined, create a new one
 		new Eclass(t, l);
 		Tpart tp(t, l);
@@ -114,11 +115,11 @@ Tokid::constituents(int l)
 	// Make r be the Tparts of the ECs covering our tokid t
 	for (;;) {
 		if (DP())
-			cout << "Tokid = " << (e->first) << " Eclass = " << e->second << "\n" << (*(e->second)) << "\n";
-		int covered = (e->second)->get_len();
+			cout << "Tokid = " << t << " Eclass = " << e << "\n" << (*e) << "\n";
+		int covered = e->get_len();
 		if (!Pdtoken::skipping()) {
 			// Add the existing classes to our current project
-			(e->second)->set_attribute(Project::get_current_projid());
+			e->set_attribute(Project::get_current_projid());
 			if (DP())
 				cout << "Set projid to " << Project::get_current_projid() << "\n";
 		}
@@ -131,10 +132,10 @@ Tokid::constituents(int l)
 		if (l == 0)
 			return (r);
 		t += covered;
-		e = tm.find(t);
-		// csassert(e != Tokid::tm.end());
+		e = t.check_ec();
+		// csassert(e != NULL);
 		// Can only happen if we are deleting ECs with -m
-		if (e == Tokid::tm.end()) {
+		if (e == NULL) {
 			// No EC defined, create a new one covering the rest
 			new Eclass(t, l);
 			Tpart tp(t, l);
@@ -149,26 +150,25 @@ void
 Tokid::set_ec_attribute(enum e_attribute a, int l) const
 {
 	Tokid t = *this;
-	dequeTpart r;
-	mapTokidEclass::const_iterator e = tm.find(t);
+	Eclass *e = t.check_ec();
 
-	if (e == Tokid::tm.end()) {
+	if (e == NULL) {
 		// No EC defined, create a new one
-		Eclass *e = new Eclass(t, l);
+		e = new Eclass(t, l);
 		e->set_attribute(a);
 		return;
 	}
 	// Set the ECs covering our tokid t
 	for (;;) {
-		int covered = (e->second)->get_len();
-		(e->second)->set_attribute(a);
+		int covered = e->get_len();
+		e->set_attribute(a);
 		l -= covered;
 		csassert(l >= 0);
 		if (l == 0)
 			return;
 		t += covered;
-		e = tm.find(t);
-		csassert(e != Tokid::tm.end());
+		e = t.check_ec();
+		csassert(e != NULL);
 	}
 }
 
@@ -177,24 +177,23 @@ bool
 Tokid::has_ec_attribute(enum e_attribute a, int l) const
 {
 	Tokid t = *this;
-	dequeTpart r;
-	mapTokidEclass::const_iterator e = tm.find(t);
+	Eclass *e = t.check_ec();
 
-	if (e == Tokid::tm.end())
+	if (e == NULL)
 		// No EC defined, create a new one
 		return false;
 	// Check the ECs covering our tokid t
 	for (;;) {
-		int covered = (e->second)->get_len();
-		if ((e->second)->get_attribute(a))
+		int covered = e->get_len();
+		if (e->get_attribute(a))
 			return true;
 		l -= covered;
 		csassert(l >= 0);
 		if (l == 0)
 			return false;
 		t += covered;
-		e = tm.find(t);
-		csassert(e != Tokid::tm.end());
+		e = t.check_ec();
+		csassert(e != NULL);
 	}
 }
 
@@ -255,7 +254,7 @@ main()
 	// Test for the constituent
 	Tokid x(Fileid("main.cpp"), 20);
 
-	dequeTpart dt = x.constituents(10);
+	vectorTpart dt = x.constituents(10);
 	cout << "Initial dt: " << dt << "\n";
 	cout << "Split EC: " << *x.get_ec()->split(2);
 	dt = x.constituents(10);
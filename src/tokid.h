@@ -44,28 +44,28 @@ using namespace std;
 
 #include "cpp.h"
 #include "fileid.h"
+#include "smallvec.h"
 
 class Eclass;
 
 class Tokid;
 class Tpart;
 typedef deque <Tokid> dequeTokid;
-typedef deque <Tpart> dequeTpart;
+// Nearly all tokens consist of a single part
+typedef SmallVector <Tpart, 1> vectorTpart;
 
-class Tokid;
-typedef map <Tokid, Eclass *> mapTokidEclass;
+// Dummy type used for printing all tokid equivalence classes
+struct TokidMap {};
 
+/*
+ * The mapping from tokids to their equivalence classes is kept
+ * in a per-file index (see ecindex.h), hung off the file's details.
+ */
 class Tokid {
-#ifdef PICO_QL
-public:
-#else
-private:
-#endif
-	static mapTokidEclass tm;	// Map from tokens to their equivalence
 private:
-					// classes
 	Fileid fi;			// File
 	cs_offset_t offs;		// Offset
+	static size_t nmapped;		// Tokids mapped to equivalence classes
 public:
 	// Construct it, based on the fileid and offset in that file
 	Tokid(Fileid i, streampos l) : fi(i), offs((cs_offset_t)l) {};
@@ -95,15 +95,10 @@ public:
 	// Set its equivalence class to ec (done when adding it to an Eclass)
 	// use Eclass:add_tokid, not this method in all other contexts
 	inline void set_ec(Eclass *ec) const;
-	// Return an iterator for accessing the map or the end_ec() value
-	inline mapTokidEclass::iterator find_ec() const;
-	// The not-found value
-	inline mapTokidEclass::iterator end_ec();
 	// Erase the tokid's EC from the map
-	inline void erase_ec(mapTokidEclass::iterator i) const;
 	inline void erase_ec(Eclass *e) const;
 	// Returns the Tokids participating in all ECs for a token of length l
-	dequeTpart constituents(int l);
+	vectorTpart constituents(int l);
 	// Set the Tokid's equivalence class attribute
 	void set_ec_attribute(enum e_attribute a, int len) const;
 	// Return true if one of the tokid's ECs has the specified attribute
@@ -111,20 +106,21 @@ public:
 	// Clear the map of tokid equivalence classes
 	static void clear();
 	// Print the contents of the class map
-	friend ostream& operator<<(ostream& o,const map <Tokid, Eclass *>& dummy);
+	friend ostream& operator<<(ostream& o,const TokidMap& dummy);
 	// Return true if the underlying file is read-only
 	bool get_readonly() const { return fi.get_readonly(); }
 	// Accessor functions
 	inline const string& get_path() const { return fi.get_path(); }
 	inline Fileid get_fileid() const { return fi; }
 	inline streampos get_streampos() const { return (streampos)offs; }
-	static map <Tokid, Eclass *>::size_type map_size() { return tm.size(); }
+	// Return the number of tokids mapped to equivalence classes
+	static size_t map_size() { return nmapped; }
 };
 
 // Print dequeTokid sequences
 ostream& operator<<(ostream& o,const dequeTokid& dt);
 
-extern mapTokidEclass tokid_map;		// Dummy; used for printing
+extern TokidMap tokid_map;		// Dummy; used for printing
 
 inline Tokid
 operator +(const Tokid& a, int i)
@@ -188,60 +184,18 @@ operator >=(const class Tokid a, const class Tokid b)
 	return b < a || a == b;
 }
 
-inline Eclass *
-Tokid::get_ec() const
-{
-	return tm[*this];
-}
-
-inline Eclass *
-Tokid::check_ec() const
-{
-	mapTokidEclass::const_iterator i = tm.find(*this);
-	if (i == tm.end())
-		return NULL;
-	else
-		return ((*i).second);
-}
-
 inline void
 Tokid::set_ec(Eclass *ec) const
 {
-	/*
-	 * tm[*this] = ec;
-	 * Efficiently implement the functionality we need.
-	 * See Meyers Effective STL, Item 24.
-	 */
-	mapTokidEclass::iterator i = tm.lower_bound(*this);
-	if (i != tm.end() && i->first == *this)
-		i->second = ec;
-	else
-		tm.insert(i, mapTokidEclass::value_type(*this, ec));
-}
-
-inline void
-Tokid::erase_ec(mapTokidEclass::iterator i) const
-{
-	tm.erase(i);
+	if (fi.get_ec_index().set(offs, ec))
+		nmapped++;
 }
 
 inline void
 Tokid::erase_ec(Eclass *e) const
 {
-	mapTokidEclass::iterator i = tm.find(*this);
-	csassert(i != tm.end());
-	tm.erase(i);
-}
-
-inline mapTokidEclass::iterator
-Tokid::find_ec() const
-{
-	return tm.find(*this);
-}
-
-inline mapTokidEclass::iterator
-Tokid::end_ec()
-{
-	return tm.end();
+	bool found = fi.get_ec_index().erase(offs);
+	csassert(found);
+	nmapped--;
 }
 #endif /* TOKID_ */
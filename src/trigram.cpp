@@ -0,0 +1,244 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * For documentation read the corresponding .h file
+ *
+ */
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <cstring>
+#include <cstdlib>
+
+#include "trigram.h"
+
+void
+TrigramIndex::add(const string &name)
+{
+	for (string::size_type i = 0; i + 3 <= name.length(); i++)
+		pending.push_back(make_pair(key(name.c_str() + i), nnames));
+	nnames++;
+}
+
+void
+TrigramIndex::finish()
+{
+	sort(pending.begin(), pending.end());
+	pending.erase(unique(pending.begin(), pending.end()), pending.end());
+	trigrams.clear();
+	offset.clear();
+	positions.clear();
+	positions.reserve(pending.size());
+	for (vector <pair <unsigned, unsigned> >::const_iterator i = pending.begin(); i != pending.end(); i++) {
+		if (trigrams.empty() || trigrams.back() != i->first) {
+			trigrams.push_back(i->first);
+			offset.push_back(positions.size());
+		}
+		positions.push_back(i->second);
+	}
+	offset.push_back(positions.size());
+	vector <pair <unsigned, unsigned> >().swap(pending);
+}
+
+// Advance i past the bracket expression starting at re[i]
+// Return false if it is not terminated
+static bool
+skip_bracket(const string &re, string::size_type &i)
+{
+	string::size_type j = i + 1, n = re.length();
+
+	if (j < n && re[j] == '^')
+		j++;
+	if (j < n && re[j] == ']')
+		j++;
+	while (j < n && re[j] != ']')
+		if (re[j] == '[' && j + 1 < n &&
+		    (re[j + 1] == ':' || re[j + 1] == '.' || re[j + 1] == '=')) {
+			// Character class, collating symbol, or equivalence class
+			char term[] = {re[j + 1], ']', 0};
+			string::size_type e = re.find(term, j + 2);
+			if (e == string::npos)
+				return false;
+			j = e + 2;
+		} else
+			j++;
+	if (j >= n)
+		return false;
+	i = j + 1;
+	return true;
+}
+
+// Advance i past the parenthesized group starting at re[i]
+// Return false if it is not terminated
+static bool
+skip_group(const string &re, string::size_type &i)
+{
+	string::size_type n = re.length();
+	int depth = 0;
+
+	while (i < n)
+		switch (re[i]) {
+		case '\\':
+			i += 2;
+			break;
+		case '[':
+			if (!skip_bracket(re, i))
+				return false;
+			break;
+		case '(':
+			depth++;
+			i++;
+			break;
+		case ')':
+			i++;
+			if (--depth == 0)
+				return true;
+			break;
+		default:
+			i++;
+			break;
+		}
+	return false;
+}
+
+/*
+ * Only sequences of ordinary characters outside groups are considered.
+ * Anything whose meaning is not certain ends the current sequence, so
+ * that the literals found are always required; an alternation at the
+ * top level means that no literal is.
+ */
+bool
+TrigramIndex::required_literals(const string &re, vector <string> &lit)
+{
+	string run;		// Characters that must appear in sequence
+	string::size_type i = 0, n = re.length();
+
+	lit.clear();
+	while (i < n) {
+		// Obtain the next atom
+		char c = 0;
+		bool literal = false;
+		switch (re[i]) {
+		case '|':
+			lit.clear();
+			return false;
+		case '\\':
+			if (i + 1 == n)
+				return false;
+			// Other escaped characters can be operators or back-references
+			if (re[i + 1] && strchr(".[]\\()*+?{}|^$", re[i + 1])) {
+				c = re[i + 1];
+				literal = true;
+			}
+			i += 2;
+			break;
+		case '[':
+			if (!skip_bracket(re, i))
+				return false;
+			break;
+		case '(':
+			if (!skip_group(re, i))
+				return false;
+			break;
+		case ')':
+			return false;
+		case '.': case '^': case '$':
+		case '*': case '+': case '?': case '{':
+			i++;
+			break;
+		default:
+			c = re[i++];
+			literal = true;
+			break;
+		}
+		// Apply the atom's repetition operators
+		bool optional = false, repeated = false;
+		while (i < n)
+			if (re[i] == '*' || re[i] == '?') {
+				optional = true;
+				i++;
+			} else if (re[i] == '+') {
+				repeated = true;
+				i++;
+			} else if (re[i] == '{') {
+				string::size_type e = re.find('}', i);
+				if (e == string::npos)
+					return false;
+				if (atoi(re.c_str() + i + 1) == 0)
+					optional = true;
+				else
+					repeated = true;
+				i = e + 1;
+			} else
+				break;
+		if (literal && !optional)
+			run += c;
+		if (!literal || optional || repeated) {
+			if (run.length() >= 3)
+				lit.push_back(run);
+			run.clear();
+			// The last repetition is followed by what comes next
+			if (literal && !optional)
+				run += c;
+		}
+	}
+	if (run.length() >= 3)
+		lit.push_back(run);
+	return !lit.empty();
+}
+
+bool
+TrigramIndex::candidates(const string &re, vector <unsigned> &c) const
+{
+	vector <string> lit;
+	if (!required_literals(re, lit))
+		return false;
+
+	// The ranges of the positions of the names containing each trigram
+	vector <pair <unsigned, unsigned> > ranges;
+	c.clear();
+	for (vector <string>::const_iterator i = lit.begin(); i != lit.end(); i++)
+		for (string::size_type j = 0; j + 3 <= i->length(); j++) {
+			unsigned k = key(i->c_str() + j);
+			vector <unsigned>::const_iterator t = lower_bound(trigrams.begin(), trigrams.end(), k);
+			if (t == trigrams.end() || *t != k)
+				return true;		// No name can match
+			ranges.push_back(make_pair(offset[t - trigrams.begin()], offset[t - trigrams.begin() + 1]));
+		}
+
+	// Intersect the ranges, starting from the shortest one
+	vector <pair <unsigned, unsigned> >::iterator shortest = ranges.begin();
+	for (vector <pair <unsigned, unsigned> >::iterator i = ranges.begin(); i != ranges.end(); i++)
+		if (i->second - i->first < shortest->second - shortest->first)
+			shortest = i;
+	c.assign(positions.begin() + shortest->first, positions.begin() + shortest->second);
+	vector <unsigned> common;
+	for (vector <pair <unsigned, unsigned> >::const_iterator i = ranges.begin(); i != ranges.end() && !c.empty(); i++) {
+		if (i == shortest)
+			continue;
+		common.clear();
+		set_intersection(c.begin(), c.end(),
+		    positions.begin() + i->first, positions.begin() + i->second,
+		    back_inserter(common));
+		c.swap(common);
+	}
+	return true;
+}
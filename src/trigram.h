@@ -0,0 +1,80 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * A trigram index over a sequence of names, used to find the names
+ * that may match a regular expression without matching it against
+ * all of them.
+ * The names are added in order, and are identified by their position.
+ * The positions of the names containing each trigram are stored in
+ * compressed sparse row form.
+ * A regular expression is reduced to the literal strings any text it
+ * matches must contain; the candidates are the names containing all
+ * their trigrams.  The candidates are a superset of the matching names,
+ * so the expression must still be matched against them.
+ *
+ * Include synopsis:
+ * #include <string>
+ * #include <vector>
+ *
+ */
+
+#ifndef TRIGRAM_
+#define TRIGRAM_
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class TrigramIndex {
+private:
+	// Trigram and the position of a name containing it
+	vector <pair <unsigned, unsigned> > pending;
+	unsigned nnames;		// Number of names added
+	// The names containing trigrams[i] are
+	// positions[offset[i]] to positions[offset[i + 1]]
+	vector <unsigned> trigrams;
+	vector <unsigned> offset;
+	vector <unsigned> positions;
+
+	// Return the key of the trigram starting at s
+	static unsigned key(const char *s) {
+		return ((unsigned char)s[0] << 16) | ((unsigned char)s[1] << 8) | (unsigned char)s[2];
+	}
+public:
+	TrigramIndex() : nnames(0) {}
+	// Add the name at the next position
+	void add(const string &name);
+	// Make the added names available for searching
+	void finish();
+	// Return the number of names added
+	unsigned size() const { return nnames; }
+	/*
+	 * Set c to the ordered positions of the names that may match
+	 * the extended regular expression re.
+	 * Return false if the expression can not be used to narrow down
+	 * the names, in which case all must be examined.
+	 */
+	bool candidates(const string &re, vector <unsigned> &c) const;
+	// Set lit to literal strings any text matching re contains
+	// Return false if none can be determined
+	static bool required_literals(const string &re, vector <string> &lit);
+};
+
+#endif /* TRIGRAM_ */
@@ -27,6 +27,7 @@
 
 #include "ctconst.h"
 #include "ctoken.h"
+#include "pool.h"
 
 enum e_btype {
 	b_abstract,		// Abstract declaration target, to be filled-in
@@ -146,6 +147,8 @@ protected:
 	bool is_typedef() const { return get_storage_class() == c_typedef; }// True for typedefs
 	bool is_static() const { return get_storage_class() == c_static; }// True for static
 public:
+	static void *operator new(size_t s) { return Pool::allocate(s); }
+	static void operator delete(void *p, size_t s) { Pool::deallocate(p, s); }
 	// For merging
 	virtual Type merge(Tbasic *b);
 	virtual Tbasic *tobasic();
@@ -0,0 +1,86 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Marks set on the nodes of a graph while traversing it.
+ * Each traversal, such as the one made for serving a graph page,
+ * starts by clearing all marks of its kind.  Rather than visiting
+ * every node, this advances an epoch counter shared by all marks of
+ * the same kind; a mark stamped with an earlier epoch reads as clear.
+ * Thus the cost of starting a traversal no longer grows with the size
+ * of the workspace, and the state of one traversal can not leak into
+ * the next one.
+ * The Tag type distinguishes marks that are cleared independently.
+ *
+ * The epochs also belong to the web request being served: the first
+ * use of a kind of mark in a new request starts a new epoch, so no
+ * mark set while serving one request reads as set in another.
+ * Requests served concurrently run in separate processes (see
+ * dispatch.h), each with its own copy of the marks.
+ *
+ */
+
+#ifndef VISITMARK_
+#define VISITMARK_
+
+// The web requests whose traversals the marks belong to
+class VisitRequest {
+public:
+	// Return the ordinal of the request being served
+	static unsigned &current() { static unsigned n; return n; }
+	// Start serving a new request
+	static void begin() { current()++; }
+};
+
+template <class Tag>
+class VisitMark {
+private:
+	static unsigned current;	// Epoch of the current traversal
+	static unsigned request;	// Request of the current epoch
+	unsigned epoch;			// Epoch in which bits were set
+	unsigned char bits;		// Mark bits
+	// Return the current epoch, starting a new one in a new request
+	static unsigned now() {
+		if (request != VisitRequest::current()) {
+			request = VisitRequest::current();
+			current++;
+		}
+		return current;
+	}
+public:
+	VisitMark() : epoch(0), bits(0) {}
+	// Clear the marks of all nodes
+	static void clear_all() { now(); current++; }
+	// Clear this mark
+	void clear() { bits = 0; }
+	// Set the bits in v
+	void set(unsigned char v = 1) {
+		if (epoch != now()) {
+			epoch = current;
+			bits = 0;
+		}
+		bits |= v;
+	}
+	// Return the bits set in the current traversal
+	unsigned char get() const { return epoch == now() ? bits : 0; }
+};
+
+template <class Tag> unsigned VisitMark<Tag>::current = 1;
+template <class Tag> unsigned VisitMark<Tag>::request;
+
+#endif /* VISITMARK_ */
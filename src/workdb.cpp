@@ -57,6 +57,9 @@
 #include "type.h"
 #include "stab.h"
 #include "sql.h"
+#include "parallel.h"
+#include "call.h"
+#include "fcgraph.h"
 #include "workdb.h"
 
 // Our identifiers to store as a set
@@ -93,53 +96,111 @@ insert_eclass(Sql *db, ostream &of, Eclass *e, const string &name)
 	// Update metrics
 	id_msum.add_unique_id(e);
 
-	of << "INSERT INTO IDS VALUES(" <<
-	ptr_offset(e) << ",'" <<
-	name << "'," <<
-	db->boolval(e->get_attribute(is_readonly)) << ',' <<
-	db->boolval(e->get_attribute(is_undefined_macro)) << ',' <<
-	db->boolval(e->get_attribute(is_macro)) << ',' <<
-	db->boolval(e->get_attribute(is_macro_arg)) << ',' <<
-	db->boolval(e->get_attribute(is_ordinary)) << ',' <<
-	db->boolval(e->get_attribute(is_suetag)) << ',' <<
-	db->boolval(e->get_attribute(is_sumember)) << ',' <<
-	db->boolval(e->get_attribute(is_label)) << ',' <<
-	db->boolval(e->get_attribute(is_typedef)) << ',' <<
-	db->boolval(e->get_attribute(is_enumeration)) << ',' <<
-	db->boolval(e->get_attribute(is_yacc)) << ',' <<
-	db->boolval(e->get_attribute(is_cfunction)) << ',' <<
-	db->boolval(e->get_attribute(is_cscope)) << ',' <<
-	db->boolval(e->get_attribute(is_lscope)) << ',' <<
-	db->boolval(e->is_unused()) <<
-	");\n";
+	SqlRow(db, of, "IDS") <<
+	ptr_offset(e) <<
+	name <<
+	e->get_attribute(is_readonly) <<
+	e->get_attribute(is_undefined_macro) <<
+	e->get_attribute(is_macro) <<
+	e->get_attribute(is_macro_arg) <<
+	e->get_attribute(is_ordinary) <<
+	e->get_attribute(is_suetag) <<
+	e->get_attribute(is_sumember) <<
+	e->get_attribute(is_label) <<
+	e->get_attribute(is_typedef) <<
+	e->get_attribute(is_enumeration) <<
+	e->get_attribute(is_yacc) <<
+	e->get_attribute(is_cfunction) <<
+	e->get_attribute(is_cscope) <<
+	e->get_attribute(is_lscope) <<
+	e->is_unused();
 	// The projects each EC belongs to
 	for (unsigned j = attr_end; j < Attributes::get_num_attributes(); j++)
 		if (e->get_attribute(j))
-			of << "INSERT INTO IDPROJ VALUES(" <<
-			ptr_offset(e) << ',' << j << ");\n";
+			SqlRow(db, of, "IDPROJ") << ptr_offset(e) << j;
 }
 
+/*
+ * The rows of a file's contents and the identifiers found in it,
+ * recorded by file_dump so that files can be dumped in parallel
+ * and written out in order by the main thread.
+ */
+class DumpBuffer: public Sql {
+private:
+	enum e_item {
+		i_row,		// Start of a table's row
+		i_id,		// Identifier occurrence
+		i_bool,		// Fields of the current row
+		i_int,
+		i_real,
+		i_string,
+	};
+	struct Item {
+		e_item type;
+		union {
+			const char *table;	// i_row
+			Eclass *ec;		// i_id
+			bool b;			// i_bool
+			long long i;		// i_int
+			double d;		// i_real
+		};
+		string s;			// i_id name and i_string
+		Item(e_item t) : type(t), i(0) {}
+	};
+	vector <Item> items;
+public:
+	// Record an occurrence of the identifier ec named name
+	void identifier(Eclass *ec, const string &name) {
+		items.push_back(Item(i_id));
+		items.back().ec = ec;
+		items.back().s = name;
+	}
+	void begin_row(ostream &of, const char *table) {
+		items.push_back(Item(i_row));
+		items.back().table = table;
+	}
+	void field(bool v) {
+		items.push_back(Item(i_bool));
+		items.back().b = v;
+	}
+	void field(long long v) {
+		items.push_back(Item(i_int));
+		items.back().i = v;
+	}
+	void field(double v) {
+		items.push_back(Item(i_real));
+		items.back().d = v;
+	}
+	void field(const string &v) {
+		items.push_back(Item(i_string));
+		items.back().s = v;
+	}
+	void end_row() {}
+	// Write the recorded rows through db to of
+	void write(Sql *db, ostream &of);
+};
+
 // Chunk the input into tables
 class Chunker {
 private:
-	fifstream &in;		// Stream we are reading from
-	string table;		// Table we are chunking into
+	fbstream &in;		// Stream we are reading from
+	const char *table;	// Table we are chunking into
 	Sql *db;		// Database interface
 	ostream &of;		// Stream for writing SQL statements
 	Fileid fid;		// File we are chunking
 	streampos startpos;	// Starting position of current chunk
-	string chunk;		// Characters accumulated in the current chunk
+	string chunk;		// Characters accumulated in the current chunk (unescaped)
 public:
-	Chunker(fifstream &i, Sql *d, ostream &o, Fileid f) : in(i), table("REST"), db(d), of(o), fid(f), startpos(0) {}
+	Chunker(fbstream &i, Sql *d, ostream &o, Fileid f) : in(i), table("REST"), db(d), of(o), fid(f), startpos(0) {}
 
 	// Flush the currently collected input into the database
 	// Should be called at the point where new input is expected
 	void flush() {
 		if (chunk.length() > 0) {
-			of << "INSERT INTO " << table << " VALUES(" <<
+			SqlRow(db, of, table) <<
 			fid.get_id() <<
-			"," << (unsigned)startpos <<
-			",'" << chunk << "');\n";
+			(unsigned)startpos <<
+			chunk;
 			chunk.erase();
 		}
 		startpos = in.tellg();
@@ -150,9 +211,9 @@ public:
 	// s can be input already collected
 	void start(const char *t, const string &s = string("")) {
 		flush();
-		table = string(t);
+		table = t;
 		startpos -= s.length();
-		chunk = db->escape(s);
+		chunk = s;
 	}
 
 	void start(const char *t, char c) {
@@ -160,28 +221,29 @@ public:
 	}
 
 	inline void add(char c) {
-		chunk += db->escape(c);
+		chunk += c;
 	}
 };
 
 // Add the contents of a file to the Tokens, Comments, Strings, and Rest tables
-// As a side-effect insert corresponding identifiers in the database
+// As a side-effect record the corresponding identifiers
 // and populate the LineOffset table
+// This invalidates the file's metrics
 static void
-file_dump(Sql *db, ostream &of, Fileid fid)
+file_dump(DumpBuffer &db, ostream &of, Fileid fid)
 {
 	streampos bol(0);			// Beginning of line
 	bool at_bol = true;
 	int line_number = 1;
 	enum e_cfile_state cstate = s_normal;	// C file state machine
 
-	fifstream in;
-	in.open(fid.get_path().c_str(), ios::binary);
+	fbstream in;
+	in.open(fid);
 	if (in.fail()) {
 		perror(fid.get_path().c_str());
 		exit(1);
 	}
-	Chunker chunker(in, db, of, fid);
+	Chunker chunker(in, &db, of, fid);
 	// Go through the file character by character
 	for (;;) {
 		Tokid ti;
@@ -198,18 +260,17 @@ file_dump(Sql *db, ostream &of, Fileid fid)
 		    (isalnum(c) || c == '_') &&
 		    (ec = ti.check_ec()) &&
 		    ec->is_identifier()) {
-			id_msum.add_id(ec);
 			string s;
 			s = (char)val;
 			int len = ec->get_len();
 			for (int j = 1; j < len; j++)
 				s += (char)in.get();
-			insert_eclass(db, of, ec, s);
+			db.identifier(ec, s);
 			fid.metrics().process_id(s, ec);
 			chunker.flush();
-			of << "INSERT INTO TOKENS VALUES(" << fid.get_id() <<
-			"," << (unsigned)ti.get_streampos() << "," <<
-			ptr_offset(ec) << ");\n";
+			SqlRow(&db, of, "TOKENS") << fid.get_id() <<
+			(unsigned)ti.get_streampos() <<
+			ptr_offset(ec);
 		} else {
 			fid.metrics().process_char(c);
 			if (c == '\n') {
@@ -218,10 +279,10 @@ file_dump(Sql *db, ostream &of, Fileid fid)
 				line_number++;
 			} else {
 				if (at_bol) {
-					of << "INSERT INTO LINEPOS VALUES(" <<
+					SqlRow(&db, of, "LINEPOS") <<
 					fid.get_id() <<
-					"," << (unsigned)bol <<
-					"," << line_number << ");\n";
+					(unsigned)bol <<
+					line_number;
 					at_bol = false;
 				}
 			}
@@ -302,11 +363,62 @@ file_dump(Sql *db, ostream &of, Fileid fid)
 	chunker.flush();
 }
 
+// Add the details of a file, including its metrics, to the Files table
+static void
+file_details(Sql *db, ostream &of, Fileid fid)
+{
+	SqlRow row(db, of, "FILES");
+	row <<
+	fid.get_id() <<
+	fid.get_path() <<
+	fid.get_readonly();
+	for (int j = 0; j < FileMetrics::metric_max; j++)
+		if (!Metrics::is_internal<FileMetrics>(j))
+			row << fid.metrics().get_metric(j);
+}
+
+void
+DumpBuffer::write(Sql *db, ostream &of)
+{
+	bool in_row = false;
+
+	for (vector <Item>::const_iterator i = items.begin(); i != items.end(); i++)
+		switch (i->type) {
+		case i_row:
+			if (in_row)
+				db->end_row();
+			db->begin_row(of, i->table);
+			in_row = true;
+			break;
+		case i_id:
+			if (in_row)
+				db->end_row();
+			in_row = false;
+			id_msum.add_id(i->ec);
+			insert_eclass(db, of, i->ec, i->s);
+			break;
+		case i_bool:
+			db->field(i->b);
+			break;
+		case i_int:
+			db->field(i->i);
+			break;
+		case i_real:
+			db->field(i->d);
+			break;
+		case i_string:
+			db->field(i->s);
+			break;
+		}
+	if (in_row)
+		db->end_row();
+}
+
 
 void
 workdb_schema(Sql *db, ostream &of)
 {
-	cout <<
+	of <<
 		// BEGIN AUTOSCHEMA
 		"CREATE TABLE IDS("			// Details of interdependant identifiers appearing in the workspace
 		"EID " << db->ptrtype() << " PRIMARY KEY,"	// Unique identifier key
@@ -336,8 +448,8 @@ workdb_schema(Sql *db, ostream &of)
 		// AUTOSCHEMA INCLUDE filemetrics.cpp FileMetrics
 		for (int i = 0; i < FileMetrics::metric_max; i++)
 			if (!Metrics::is_internal<FileMetrics>(i))
-				cout << ",\n" << Metrics::get_dbfield<FileMetrics>(i) << " INTEGER";
-		cout << ");\n"
+				of << ",\n" << Metrics::get_dbfield<FileMetrics>(i) << " INTEGER";
+		of << ");\n"
 
 		"CREATE TABLE TOKENS("			// Instances of identifier tokens within the source code
 		"FID INTEGER,"				// File key (references FILES)
@@ -471,10 +583,10 @@ workdb_schema(Sql *db, ostream &of)
 		// AUTOSCHEMA INCLUDE funmetrics.cpp FunMetrics
 		for (int i = 0; i < FunMetrics::metric_max; i++)
 			if (!Metrics::is_internal<FunMetrics>(i))
-				cout << Metrics::get_dbfield<FunMetrics>(i) <<
+				of << Metrics::get_dbfield<FunMetrics>(i) <<
 				    (i >= FunMetrics::em_real_start ? " REAL" : " INTEGER") <<
 				    ",\n";
-		cout <<
+		of <<
 		"FIDBEGIN INTEGER,\n"			// File key of the function's definition begin (references FILES)
 		"FOFFSETBEGIN INTEGER,\n"		// Offset of definition begin within the file
 		"FIDEND INTEGER,\n"			// File key of the function's definition end (references FILES)
@@ -498,6 +610,14 @@ workdb_schema(Sql *db, ostream &of)
 		"FOREIGN KEY(DESTID) REFERENCES FUNCTIONS(ID)"
 		");\n"
 
+		"CREATE TABLE FILECALLS("		// Function calls between files
+		"SOURCEID INTEGER, "			// Key of file defining calling functions (references FILES)
+		"DESTID INTEGER, "			// Key of file defining called functions (references FILES)
+		"PRIMARY KEY(SOURCEID, DESTID), "
+		"FOREIGN KEY(SOURCEID) REFERENCES FILES(FID), "
+		"FOREIGN KEY(DESTID) REFERENCES FILES(FID)"
+		");\n"
+
 		"CREATE TABLE FILECOPIES("		// Files occuring in more than one copy
 		"GROUPID INTEGER, "			// File group identifier
 		"FID INTEGER, "				// Key of file belonging to a group of identical files (references FILES)
@@ -509,6 +629,29 @@ workdb_schema(Sql *db, ostream &of)
 		"";
 }
 
+/*
+ * Indexes for the common joins, which the schema's keys do not cover.
+ * They are created after the data have been loaded, which is faster
+ * than updating them for each inserted row.
+ */
+void
+workdb_indexes(Sql *db, ostream &of)
+{
+	of <<
+		"CREATE INDEX TOKENS_EID ON TOKENS(EID);\n"
+		"CREATE INDEX IDPROJ_EID ON IDPROJ(EID);\n"
+		"CREATE INDEX FILEPROJ_FID ON FILEPROJ(FID);\n"
+		"CREATE INDEX FUNCTIONS_FID ON FUNCTIONS(FID);\n"
+		"CREATE INDEX FUNCTIONID_EID ON FUNCTIONID(EID);\n"
+		"CREATE INDEX FCALLS_SOURCEID ON FCALLS(SOURCEID);\n"
+		"CREATE INDEX FCALLS_DESTID ON FCALLS(DESTID);\n"
+		"CREATE INDEX FILECALLS_DESTID ON FILECALLS(DESTID);\n"
+		"CREATE INDEX DEFINERS_CUID ON DEFINERS(CUID);\n"
+		"CREATE INDEX INCLUDERS_CUID ON INCLUDERS(CUID);\n"
+		"CREATE INDEX PROVIDERS_CUID ON PROVIDERS(CUID);\n"
+		"CREATE INDEX INCTRIGGERS_CUID ON INCTRIGGERS(CUID);\n";
+}
+
 void
 workdb_rest(Sql *db, ostream &of)
 {
@@ -516,39 +659,56 @@ workdb_rest(Sql *db, ostream &of)
 	const Project::proj_map_type &m = Project::get_project_map();
 	Project::proj_map_type::const_iterator pm;
 	for (pm = m.begin(); pm != m.end(); pm++)
-		cout << "INSERT INTO PROJECTS VALUES(" <<
-		(*pm).second << ",'" << (*pm).first << "');\n";
+		SqlRow(db, of, "PROJECTS") <<
+		(*pm).second << (*pm).first;
 
 	vector <Fileid> files = Fileid::files(true);
 
 	int groupnum = 0;
 
+	/*
+	 * The files' contents are dumped in parallel into buffers,
+	 * which are written out in order.  The files are processed in
+	 * windows, to bound the memory the buffers occupy.
+	 */
+	size_t window = Parallel::get_threads() * 4;
+	vector <DumpBuffer> dumps;
+
 	// Details and contents of each file
 	// As a side effect populate the EC identifier member
 	for (vector <Fileid>::iterator i = files.begin(); i != files.end(); i++) {
-		cout << "INSERT INTO FILES VALUES(" <<
-		(*i).get_id() << ",'" <<
-		(*i).get_path() << "'," <<
-		db->boolval((*i).get_readonly());
-		for (int j = 0; j < FileMetrics::metric_max; j++)
-			if (!Metrics::is_internal<FileMetrics>(j))
-				cout << ',' << i->metrics().get_metric(j);
-		cout << ");\n";
-		// This invalidates the file's metrics
-		file_dump(db, cout, (*i));
+		size_t n = i - files.begin();
+		if (n % window == 0) {
+			size_t len = min(window, files.size() - n);
+			dumps.clear();
+			dumps.resize(len);
+			// Record the details before the contents invalidate them
+			for (size_t j = 0; j < len; j++)
+				file_details(&dumps[j], of, files[n + j]);
+			Parallel::for_each(len, [&](size_t j, unsigned t) {
+				file_dump(dumps[j], of, files[n + j]);
+			});
+		}
+		dumps[n % window].write(db, of);
 		// The projects this file belongs to
 		for (unsigned j = attr_end; j < Attributes::get_num_attributes(); j++)
 			if ((*i).get_attribute(j))
-				cout << "INSERT INTO FILEPROJ VALUES(" <<
-				(*i).get_id() << ',' << j << ");\n";
+				SqlRow(db, of, "FILEPROJ") <<
+				(*i).get_id() << j;
 
 		// Copies of the file
 		const set <Fileid> &copies(i->get_identical_files());
 		if (copies.size() > 1 && copies.begin()->get_id() == i->get_id()) {
 			for (set <Fileid>::const_iterator j = copies.begin(); j != copies.end(); j++)
-				cout << "INSERT INTO FILECOPIES VALUES(" <<
-					 groupnum << ',' << j->get_id() << ");\n";
+				SqlRow(db, of, "FILECOPIES") <<
+					 groupnum << j->get_id();
 			groupnum++;
 		}
 	}
+
+	// Function calls between files, once all files have been written
+	for (vector <Fileid>::iterator i = files.begin(); i != files.end(); i++)
+		for (FileCallGraph::const_iterator j = FileCallGraph::calls_begin(*i); j != FileCallGraph::calls_end(*i); j++)
+			SqlRow(db, of, "FILECALLS") <<
+				i->get_id() << j->get_id();
 }
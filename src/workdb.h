@@ -32,5 +32,6 @@ using namespace std;
 
 void workdb_schema(Sql *db, ostream &of);
 void workdb_rest(Sql *db, ostream &of);
+void workdb_indexes(Sql *db, ostream &of);
 
 #endif // WORKDB_